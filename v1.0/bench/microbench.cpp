@@ -0,0 +1,385 @@
+// Kernel microbenchmarks: Person parsing, grade computation, the sort, each
+// split strategy, the writer, name lookups and name searches, per container
+// and input size. Container kernels go through Pipeline::ContainerOps, so any
+// container the pipeline accepts can be added with one BENCHMARK_TEMPLATE line.
+// Every benchmark reports items/s, where one item is one student record (one
+// lookup for the BM_Lookup* cases, one edit for BM_Edit*; a search covers all
+// records).
+
+#include "Analyzer.h"
+#include "FileGenerator.h"
+#include "IncrementalDataset.h"
+#include "NameIndex.h"
+#include "NameSearch.h"
+#include "Pipeline.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<Student>& dataset(std::size_t n) {
+    static std::map<std::size_t, std::vector<Student>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        FileGenerator::RecordSource src(n);
+        it = cache.emplace(n, Analyzer::readVectorFromSource(src)).first;
+    }
+    return it->second;
+}
+
+const std::string& datasetText(std::size_t n) {
+    static std::map<std::size_t, std::string> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        std::ostringstream out;
+        FileGenerator::writeRecords(out, n, FileGenerator::GeneratorOptions{});
+        it = cache.emplace(n, out.str()).first;
+    }
+    return it->second;
+}
+
+template <typename C>
+C datasetAs(std::size_t n) {
+    const auto& v = dataset(n);
+    return C(v.begin(), v.end());
+}
+
+std::string tempPath() {
+    return (std::filesystem::temp_directory_path() / "sgc_microbench.txt").string();
+}
+
+template <typename C>
+void sortDesc(C& c) { Pipeline::ContainerOps<C>::sort(c, 1); }
+
+template <typename C>
+void split1(const C& s, C& p, C& f) { Pipeline::ContainerOps<C>::splitCopy(s, p, f); }
+
+template <typename C>
+void split2(C& s, C& f, PartitionMode m) { Pipeline::ContainerOps<C>::splitMove(s, f, m); }
+
+using PmrVector = std::pmr::vector<Student>;
+using Segmented = SegmentedStudents;
+using PooledList = PooledStudents;
+
+void setItems(benchmark::State& state) {
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// -------------------- PARSE / GRADE --------------------
+
+void BM_PersonParse(benchmark::State& state) {
+    const std::string& text = datasetText(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::istringstream in(text);
+        Student s;
+        while (in >> s) benchmark::DoNotOptimize(s.finalAvgCached());
+    }
+    setItems(state);
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.size()));
+}
+
+void BM_ComputeCache(benchmark::State& state) {
+    std::vector<Student> v = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (auto& s : v) s.computeCache();
+        benchmark::ClobberMemory();
+    }
+    setItems(state);
+}
+
+void BM_FinalAvg(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto& s : v) sum += s.finalAvg();
+        benchmark::DoNotOptimize(sum);
+    }
+    setItems(state);
+}
+
+void BM_Median(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto& s : v) sum += s.median();
+        benchmark::DoNotOptimize(sum);
+    }
+    setItems(state);
+}
+
+// -------------------- SORT / SPLIT / WRITE --------------------
+
+template <typename C>
+void BM_Sort(benchmark::State& state) {
+    const C input = datasetAs<C>(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = input;
+        state.ResumeTiming();
+        sortDesc(c);
+        benchmark::DoNotOptimize(c);
+    }
+    setItems(state);
+}
+
+// The total order (grade, surname, name): through packed keys as the
+// pipelines do with SGC_ORDER=total, and with the plain string comparator.
+template <typename C>
+void BM_SortTotal(benchmark::State& state) {
+    const C input = datasetAs<C>(static_cast<std::size_t>(state.range(0)));
+    Sorter::setOrder(Sorter::SortOrder::Total);
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = input;
+        state.ResumeTiming();
+        sortDesc(c);
+        benchmark::DoNotOptimize(c);
+    }
+    Sorter::setOrder(Sorter::SortOrder::Grade);
+    setItems(state);
+}
+
+void BM_SortTotalComparator(benchmark::State& state) {
+    const auto& input = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<Student> v = input;
+        state.ResumeTiming();
+        std::sort(v.begin(), v.end(), Sorter::ByGradeSurnameName());
+        benchmark::DoNotOptimize(v);
+    }
+    setItems(state);
+}
+
+template <typename C>
+void BM_SplitStrategy1(benchmark::State& state) {
+    C input = datasetAs<C>(static_cast<std::size_t>(state.range(0)));
+    sortDesc(input);
+    for (auto _ : state) {
+        C passed, failed;
+        split1(input, passed, failed);
+        benchmark::DoNotOptimize(passed);
+        benchmark::DoNotOptimize(failed);
+    }
+    setItems(state);
+}
+
+template <typename C>
+void BM_SplitStrategy2(benchmark::State& state) {
+    C input = datasetAs<C>(static_cast<std::size_t>(state.range(0)));
+    sortDesc(input);
+    const auto pmode = static_cast<PartitionMode>(state.range(1));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = input;
+        state.ResumeTiming();
+        C failed;
+        split2(c, failed, pmode);
+        benchmark::DoNotOptimize(failed);
+    }
+    setItems(state);
+}
+
+template <typename C>
+void BM_Write(benchmark::State& state) {
+    const C input = datasetAs<C>(static_cast<std::size_t>(state.range(0)));
+    const std::string path = tempPath();
+    for (auto _ : state) {
+        Pipeline::writeFile(path, input);
+    }
+    std::remove(path.c_str());
+    setItems(state);
+}
+
+// -------------------- LOOKUP / SEARCH --------------------
+
+// count keys spread evenly over the dataset, so every lookup hits
+std::vector<NameIndex::Key> lookupKeys(const std::vector<Student>& v, std::size_t count) {
+    std::vector<NameIndex::Key> keys;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Student& s = v[(i * v.size() + v.size() / 2) / count];
+        keys.push_back({s.getName(), s.getSurname()});
+    }
+    return keys;
+}
+
+void BM_LookupFindIf(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    const auto keys = lookupKeys(v, 16);
+    for (auto _ : state) {
+        for (const auto& k : keys) {
+            auto it = std::find_if(v.begin(), v.end(), [&](const Student& s) {
+                return s.getName() == k.name && s.getSurname() == k.surname;
+            });
+            benchmark::DoNotOptimize(it);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+void BM_LookupIndex(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    const NameIndex index(v);
+    const auto keys = lookupKeys(v, 4096);
+    for (auto _ : state) {
+        for (const auto& k : keys) benchmark::DoNotOptimize(index.find(k.name, k.surname));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+void BM_LookupIndexBatch(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    const NameIndex index(v);
+    const auto keys = lookupKeys(v, 4096);
+    for (auto _ : state) benchmark::DoNotOptimize(index.findBatch(keys));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+void BM_NameIndexBuild(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        NameIndex index(v);
+        benchmark::DoNotOptimize(index.capacity());
+    }
+    setItems(state);
+    state.counters["bytes_per_record"] = static_cast<double>(NameIndex(v).memoryBytes()) / static_cast<double>(v.size());
+}
+
+// a surname with its first two letters cut off: a substring match, not a prefix
+std::string searchPattern(const std::vector<Student>& v) {
+    return v[v.size() / 2].getSurname().substr(2);
+}
+
+void BM_SubstringScan(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    const std::string pattern = searchPattern(v);
+    for (auto _ : state) benchmark::DoNotOptimize(NameSearch::scanSubstring(v, pattern));
+    setItems(state);
+}
+
+void BM_SubstringIndex(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    const NameSearch index(v);
+    const std::string pattern = searchPattern(v);
+    for (auto _ : state) benchmark::DoNotOptimize(index.findSubstring(pattern));
+    setItems(state);
+}
+
+void BM_NameSearchBuild(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        NameSearch index(v);
+        benchmark::DoNotOptimize(index.size());
+    }
+    setItems(state);
+    state.counters["bytes_per_record"] = static_cast<double>(NameSearch(v).memoryBytes()) / static_cast<double>(v.size());
+}
+
+// -------------------- EDIT --------------------
+// One student's grades change: refile it in the order-statistics tree, or
+// re-run the sort and the pass/fail split over the whole vector.
+
+void BM_EditIncremental(benchmark::State& state) {
+    const auto& v = dataset(static_cast<std::size_t>(state.range(0)));
+    IncrementalDataset data;
+    for (const auto& s : v) data.add(s);
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        const auto id = static_cast<IncrementalDataset::Id>(i * 7919 % v.size() + 1);
+        data.update(id, {static_cast<int>(i % 11), 5, 7}, static_cast<int>(i * 3 % 11));
+        benchmark::DoNotOptimize(data.passed());
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_EditResort(benchmark::State& state) {
+    std::vector<Student> v = dataset(static_cast<std::size_t>(state.range(0)));
+    sortDesc(v);
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        Student& s = v[i * 7919 % v.size()];
+        s = Student(s.getName(), s.getSurname(), {static_cast<int>(i % 11), 5, 7}, static_cast<int>(i * 3 % 11));
+        sortDesc(v);
+        auto passed = std::partition_point(v.begin(), v.end(), Pipeline::isPassed);
+        benchmark::DoNotOptimize(passed);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void sizes(benchmark::internal::Benchmark* b) {
+    for (std::int64_t n : {1000, 10000, 100000, 1000000}) b->Arg(n);
+    b->Unit(benchmark::kMillisecond);
+}
+
+void sizesAndModes(benchmark::internal::Benchmark* b) {
+    for (std::int64_t n : {1000, 10000, 100000, 1000000}) {
+        b->Args({n, static_cast<std::int64_t>(PartitionMode::Partition)});
+        b->Args({n, static_cast<std::int64_t>(PartitionMode::StablePartition)});
+    }
+    b->ArgNames({"n", "pmode"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK(BM_PersonParse)->Apply(sizes);
+BENCHMARK(BM_ComputeCache)->Apply(sizes);
+BENCHMARK(BM_FinalAvg)->Apply(sizes);
+BENCHMARK(BM_Median)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(BM_Sort, std::vector<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Sort, std::deque<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Sort, std::list<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Sort, PmrVector)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Sort, Segmented)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Sort, PooledList)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SortTotal, std::vector<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SortTotal, std::list<Student>)->Apply(sizes);
+BENCHMARK(BM_SortTotalComparator)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, std::vector<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, std::deque<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, std::list<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, PmrVector)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, Segmented)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy1, PooledList)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, std::vector<Student>)->Apply(sizesAndModes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, std::deque<Student>)->Apply(sizesAndModes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, std::list<Student>)->Apply(sizesAndModes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, PmrVector)->Apply(sizesAndModes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, Segmented)->Apply(sizesAndModes);
+BENCHMARK_TEMPLATE(BM_SplitStrategy2, PooledList)->Apply(sizesAndModes);
+
+BENCHMARK_TEMPLATE(BM_Write, std::vector<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Write, std::deque<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Write, std::list<Student>)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Write, PmrVector)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Write, Segmented)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_Write, PooledList)->Apply(sizes);
+
+BENCHMARK(BM_LookupFindIf)->Apply(sizes);
+BENCHMARK(BM_LookupIndex)->Apply(sizes);
+BENCHMARK(BM_LookupIndexBatch)->Apply(sizes);
+BENCHMARK(BM_NameIndexBuild)->Apply(sizes);
+BENCHMARK(BM_SubstringScan)->Apply(sizes);
+BENCHMARK(BM_SubstringIndex)->Apply(sizes);
+BENCHMARK(BM_NameSearchBuild)->Apply(sizes);
+
+BENCHMARK(BM_EditIncremental)->Apply(sizes);
+BENCHMARK(BM_EditResort)->Apply(sizes);
+
+BENCHMARK_MAIN();
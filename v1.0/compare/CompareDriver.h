@@ -0,0 +1,71 @@
+#ifndef COMPAREDRIVER_H
+#define COMPAREDRIVER_H
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Entry point shared by the per-version drivers that `student-grade-calculator
+// compare` launches. Each driver links one version's core (and nothing from
+// the others) and runs one Strategy 1 pipeline once:
+//
+//   sgc-compare-<version> <container> <input> <passed out> <failed out>
+//
+// printing "<students> <read> <sort> <split> <write> <total>" in ms on stdout.
+// Stage times are the version's own; total is timed here, around the whole
+// call, so it means the same thing for every version. Exit status 2: the
+// version has no pipeline for that container.
+namespace CompareDriver {
+
+struct Times {
+    std::size_t students = 0;
+    double read_ms = 0.0;
+    double sort_ms = 0.0;
+    double split_ms = 0.0;
+    double write_ms = 0.0;
+};
+
+// Every version's PerfResult has these fields.
+template <typename R>
+Times fromResult(const R& r) {
+    return Times{r.total_students, r.read_ms, r.sort_ms, r.split_ms, r.write_ms};
+}
+
+inline double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+using Pipeline = std::function<Times(const std::string& input, const std::string& outPass, const std::string& outFail)>;
+
+inline int run(int argc, char** argv, const std::vector<std::pair<std::string, Pipeline>>& pipelines) {
+    if (argc != 5) {
+        std::cerr << "usage: " << argv[0] << " <container> <input> <passed out> <failed out>\n";
+        return 1;
+    }
+    const std::string container = argv[1];
+    for (const auto& [name, pipeline] : pipelines) {
+        if (name != container) continue;
+        try {
+            auto t0 = std::chrono::steady_clock::now();
+            Times t = pipeline(argv[2], argv[3], argv[4]);
+            double total = msSince(t0);
+            std::cout << std::fixed << std::setprecision(4) << t.students << " " << t.read_ms << " " << t.sort_ms
+                      << " " << t.split_ms << " " << t.write_ms << " " << total << "\n";
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << argv[0] << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 2;
+}
+
+} // namespace CompareDriver
+
+#endif
@@ -0,0 +1,68 @@
+// v0.1 shipped a loader and a menu, not a pipeline. Reading follows its
+// loadFromFile: getline, a stringstream per line, operator>> into one reused
+// Person, copied into the vector. Sort, split and write use the v0.1 Person
+// API the way v0.2 first put them together; finalAvg() is recomputed on every
+// call (no cache yet) and operator<< writes v0.1's formatted table row.
+
+#include "CompareDriver.h"
+#include "Person.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using CompareDriver::msSince;
+using Clock = std::chrono::steady_clock;
+
+static const double PASS_CUTOFF = 5.0;
+
+static void writeToFile(const std::string& filename, const std::vector<Person>& students) {
+    std::ofstream out(filename);
+    if (!out.is_open()) throw std::runtime_error("Cannot open file for writing: " + filename);
+    for (const auto& s : students) out << s << "\n";
+}
+
+static CompareDriver::Times runVectorPipeline(const std::string& input, const std::string& outPass,
+                                              const std::string& outFail) {
+    CompareDriver::Times t;
+
+    auto t0 = Clock::now();
+    std::ifstream file(input);
+    if (!file.is_open()) throw std::runtime_error("Cannot open " + input);
+    std::vector<Person> students;
+    Person temp;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        ss >> temp;
+        students.push_back(temp);
+    }
+    t.read_ms = msSince(t0);
+    t.students = students.size();
+
+    t0 = Clock::now();
+    std::sort(students.begin(), students.end(),
+              [](const Person& a, const Person& b) { return a.finalAvg() > b.finalAvg(); });
+    t.sort_ms = msSince(t0);
+
+    t0 = Clock::now();
+    std::vector<Person> pass;
+    std::vector<Person> fail;
+    for (const auto& s : students) {
+        if (s.finalAvg() >= PASS_CUTOFF) pass.push_back(s);
+        else fail.push_back(s);
+    }
+    t.split_ms = msSince(t0);
+
+    t0 = Clock::now();
+    writeToFile(outPass, pass);
+    writeToFile(outFail, fail);
+    t.write_ms = msSince(t0);
+    return t;
+}
+
+int main(int argc, char** argv) {
+    return CompareDriver::run(argc, argv, {{"vector", runVectorPipeline}});
+}
@@ -0,0 +1,14 @@
+// v0.2: every pipeline reads into a vector first; deque and list convert it
+// (outside the timed stages) and split into vectors.
+
+#include "Analyzer.h"
+#include "CompareDriver.h"
+
+int main(int argc, char** argv) {
+    using CompareDriver::fromResult;
+    return CompareDriver::run(argc, argv, {
+        {"vector", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runVectorPipeline(in, p, f)); }},
+        {"deque", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runDequePipeline(in, p, f)); }},
+        {"list", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runListPipeline(in, p, f)); }},
+    });
+}
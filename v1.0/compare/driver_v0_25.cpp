@@ -0,0 +1,14 @@
+// v0.25: direct per-container readers (tellg-per-line recovery in the vector
+// reader), finalAvg cached at parse time, copy split into the same container.
+
+#include "Analyzer.h"
+#include "CompareDriver.h"
+
+int main(int argc, char** argv) {
+    using CompareDriver::fromResult;
+    return CompareDriver::run(argc, argv, {
+        {"vector", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runVectorPipeline(in, p, f)); }},
+        {"deque", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runDequePipeline(in, p, f)); }},
+        {"list", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runListPipeline(in, p, f)); }},
+    });
+}
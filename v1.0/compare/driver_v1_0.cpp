@@ -0,0 +1,19 @@
+// v1.0: the Pipeline templates, Strategy 1 with std::partition. Honors
+// SGC_THREADS like the main executable (default 1).
+
+#include "Analyzer.h"
+#include "CompareDriver.h"
+
+static const SplitStrategy S1 = SplitStrategy::Strategy1_CopyToTwoContainers;
+static const PartitionMode PART = PartitionMode::Partition;
+
+int main(int argc, char** argv) {
+    using CompareDriver::fromResult;
+    return CompareDriver::run(argc, argv, {
+        {"vector", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runVectorPipeline(in, p, f, S1, PART)); }},
+        {"deque", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runDequePipeline(in, p, f, S1, PART)); }},
+        {"list", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runListPipeline(in, p, f, S1, PART)); }},
+        {"segmented", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runSegmentedPipeline(in, p, f, S1, PART)); }},
+        {"pooled-list", [](const auto& in, const auto& p, const auto& f) { return fromResult(Analyzer::runPooledListPipeline(in, p, f, S1, PART)); }},
+    });
+}
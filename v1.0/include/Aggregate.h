@@ -0,0 +1,66 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "Benchmark.h"
+#include "GradeStats.h"
+#include "RecordScanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Highest and lowest final grade, count, sum and pass/fail of student files
+// in one streaming pass. Only running aggregates are kept: per worker one
+// Summary whose size does not depend on the input, merged at the end.
+namespace Aggregate {
+
+// One student holding an extreme grade, and where it was read.
+struct Holder {
+    std::string name;
+    std::string surname;
+    std::size_t file = 0;     // index into the scanned file list
+    std::uint64_t offset = 0; // byte offset of its line
+};
+
+// The best (or worst) exact final grade seen, how many records share it, and
+// the first `keep` of them in input order.
+struct Extreme {
+    GradeStats::Grade grade;
+    std::uint64_t ties = 0; // records with exactly this grade; 0 = none seen
+    std::vector<Holder> holders;
+};
+
+struct Summary {
+    explicit Summary(std::size_t keep = 10) : keep(keep) {}
+
+    std::size_t keep; // tied holders kept per extreme
+    std::uint64_t records = 0;
+    std::uint64_t passed = 0;    // finalAvg >= Pipeline::PASS_CUTOFF, decided as the pipelines do
+    long double finalAvgSum = 0; // of Person::finalAvg values
+    Extreme highest;
+    Extreme lowest;
+
+    // Records of one worker must arrive in input order (file, then offset).
+    void add(const RecordScanner::Record& r, std::size_t file, std::uint64_t offset);
+    void merge(const Summary& other);
+    double mean() const { return records ? static_cast<double>(finalAvgSum / records) : 0.0; }
+};
+
+inline constexpr std::uint64_t CHUNK_BYTES = 64ull << 20;
+
+// Files are cut into line-aligned chunks of about chunkBytes, and `threads`
+// workers take chunks in input order until none are left, so a few large
+// files and many small ones both spread over the workers. Throws
+// FileException. keep is at least 1.
+Summary scanFiles(const std::vector<std::string>& files, unsigned threads = 1, std::size_t keep = 10,
+                  std::uint64_t chunkBytes = CHUNK_BYTES);
+
+// text: the v0.2 high/low lines plus ties and totals; json: everything;
+// csv: one row per kept holder (extreme,name,surname,finalAvg,file,offset).
+void report(std::ostream& out, const std::vector<std::string>& files, const Summary& s,
+            Benchmark::OutputFormat format);
+
+} // namespace Aggregate
+
+#endif
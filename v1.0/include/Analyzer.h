@@ -1,13 +1,22 @@
 #ifndef ANALYZER_H
 #define ANALYZER_H
 
+#include "FileGenerator.h"
+#include "MemoryTracker.h"
+#include "PerfCounters.h"
+#include "PoolAllocator.h"
+#include "SegmentedVector.h"
 #include "Student.h"
+#include <array>
 #include <cstddef>
 #include <deque>
 #include <list>
 #include <string>
 #include <vector>
 
+// Stage indices for the per-stage arrays in PerfResult
+enum PerfStage : std::size_t { STAGE_READ, STAGE_SORT, STAGE_SPLIT, STAGE_WRITE, STAGE_COUNT };
+
 struct PerfResult {
     double read_ms = 0.0;
     double sort_ms = 0.0;
@@ -15,8 +24,20 @@ struct PerfResult {
     double write_ms = 0.0;
     double total_ms = 0.0;
     std::size_t total_students = 0;
+
+    // filled only when PerfCounters::enabled(); counters may be individually absent
+    std::array<HwCounters, STAGE_COUNT> hw{};
+
+    // filled only when MemoryTracker::enabled()
+    std::array<MemStats, STAGE_COUNT> mem{};
 };
 
+// Fourth benchmark container: blocks of 4096 students, see SegmentedVector.h
+using SegmentedStudents = SegmentedVector<Student>;
+
+// Fifth: std::list whose nodes come from a contiguous pool, see PoolAllocator.h
+using PooledStudents = std::list<Student, PoolAllocator<Student>>;
+
 enum class SplitStrategy {
     Strategy1_CopyToTwoContainers = 1,
     Strategy2_MoveFailAndShrinkBase = 2
@@ -29,16 +50,42 @@ enum class PartitionMode {
 
 namespace Analyzer {
 
+// Worker threads for the parallel parts of the pipelines: parsing, the
+// vector/deque sort and output formatting. 1 (sequential) unless SGC_THREADS
+// in the environment or setThreads says otherwise; 0 means every hardware thread.
+unsigned threads();
+void setThreads(unsigned n);
+
 std::vector<Student> readVectorFromFile(const std::string& filename);
 std::deque<Student>  readDequeFromFile (const std::string& filename);
 std::list<Student>   readListFromFile  (const std::string& filename);
 
+// Drain an in-memory generator instead of parsing a file
+std::vector<Student> readVectorFromSource(FileGenerator::RecordSource& src);
+std::deque<Student>  readDequeFromSource (FileGenerator::RecordSource& src);
+std::list<Student>   readListFromSource  (FileGenerator::RecordSource& src);
+
 void writeToFile(const std::string& filename, const std::vector<Student>& students);
 void writeToFile(const std::string& filename, const std::deque<Student>& students);
 void writeToFile(const std::string& filename, const std::list<Student>& students);
 
+// Split kernels used by the pipelines (exposed for the microbenchmarks)
+void splitVector_Strategy1(const std::vector<Student>& students,
+                           std::vector<Student>& passed, std::vector<Student>& failed);
+void splitDeque_Strategy1(const std::deque<Student>& students,
+                          std::deque<Student>& passed, std::deque<Student>& failed);
+void splitList_Strategy1(const std::list<Student>& students,
+                         std::list<Student>& passed, std::list<Student>& failed);
+
+void splitVector_Strategy2(std::vector<Student>& students, std::vector<Student>& failed, PartitionMode pmode);
+void splitDeque_Strategy2(std::deque<Student>& students, std::deque<Student>& failed, PartitionMode pmode);
+void splitList_Strategy2(std::list<Student>& students, std::list<Student>& failed, PartitionMode pmode);
+
 void printPerf(const std::string& tag, const PerfResult& r);
 
+std::string strategyTag(SplitStrategy s); // "S1" / "S2"
+std::string pmodeTag(PartitionMode p);    // "partition" / "stable"
+
 PerfResult runVectorPipeline(const std::string& inputFile,
                              const std::string& outPass,
                              const std::string& outFail,
@@ -57,6 +104,50 @@ PerfResult runListPipeline(const std::string& inputFile,
                            SplitStrategy strat,
                            PartitionMode pmode);
 
+PerfResult runSegmentedPipeline(const std::string& inputFile,
+                                const std::string& outPass,
+                                const std::string& outFail,
+                                SplitStrategy strat,
+                                PartitionMode pmode);
+
+PerfResult runPooledListPipeline(const std::string& inputFile,
+                                 const std::string& outPass,
+                                 const std::string& outFail,
+                                 SplitStrategy strat,
+                                 PartitionMode pmode);
+
+// Same pipelines fed from a RecordSource; read_ms then measures generation
+// only. Pass empty output paths to skip the write stage as well.
+PerfResult runVectorPipeline(FileGenerator::RecordSource& src,
+                             const std::string& outPass,
+                             const std::string& outFail,
+                             SplitStrategy strat,
+                             PartitionMode pmode);
+
+PerfResult runDequePipeline(FileGenerator::RecordSource& src,
+                            const std::string& outPass,
+                            const std::string& outFail,
+                            SplitStrategy strat,
+                            PartitionMode pmode);
+
+PerfResult runListPipeline(FileGenerator::RecordSource& src,
+                           const std::string& outPass,
+                           const std::string& outFail,
+                           SplitStrategy strat,
+                           PartitionMode pmode);
+
+PerfResult runSegmentedPipeline(FileGenerator::RecordSource& src,
+                                const std::string& outPass,
+                                const std::string& outFail,
+                                SplitStrategy strat,
+                                PartitionMode pmode);
+
+PerfResult runPooledListPipeline(FileGenerator::RecordSource& src,
+                                 const std::string& outPass,
+                                 const std::string& outFail,
+                                 SplitStrategy strat,
+                                 PartitionMode pmode);
+
 // Demonstrate required algorithms: find/find_if/search on loaded container
 void demoAlgorithmSearch_Vector(const std::vector<Student>& students);
 void demoAlgorithmSearch_Deque(const std::deque<Student>& students);
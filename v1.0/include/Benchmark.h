@@ -0,0 +1,126 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Analyzer.h"
+#include "CacheControl.h"
+#include "Sorter.h"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Non-interactive benchmark runner: warmup + N repetitions per case, with
+// per-stage statistics in text, JSON or CSV form.
+namespace Benchmark {
+
+enum class ContainerKind { Vector, Deque, List, Segmented, PooledList };
+
+enum class OutputFormat { Text, Json, Csv };
+
+// "text", "json" or "csv", as every --format option takes it. Throws ParseException.
+OutputFormat parseReportFormat(const std::string& name);
+
+// s as the inside of a JSON string: quotes, backslashes and control
+// characters (\u00XX) escaped. Shared by every JSON report.
+std::string jsonEscape(const std::string& s);
+
+// Command-line helpers shared with compare: the non-empty items of a
+// comma-separated list, and a count >= 0 for flag (throws ParseException).
+std::vector<std::string> splitList(const std::string& s);
+int parseCount(const std::string& flag, const std::string& value);
+
+struct BenchConfig {
+    // File paths, or "gen:<count>[:<profile>]" for an in-memory RecordSource
+    std::vector<std::string> inputs;
+    std::vector<ContainerKind> containers = {ContainerKind::Vector, ContainerKind::Deque, ContainerKind::List,
+                                             ContainerKind::Segmented, ContainerKind::PooledList};
+    std::vector<SplitStrategy> strategies = {SplitStrategy::Strategy1_CopyToTwoContainers,
+                                             SplitStrategy::Strategy2_MoveFailAndShrinkBase};
+    std::vector<PartitionMode> pmodes = {PartitionMode::Partition};
+    // Applied to file inputs before every run (warmup included)
+    std::vector<CacheControl::CacheMode> cacheModes = {CacheControl::CacheMode::AsIs};
+    // Analyzer::setThreads value per case (gen: inputs also generate with that
+    // many threads); empty keeps the current setting.
+    std::vector<unsigned> threadCounts;
+    // sort order of every case (Sorter::setOrder while the cases run)
+    Sorter::SortOrder order = Sorter::order();
+    int warmup = 1;
+    int repetitions = 5;
+    bool writeOutputs = true;
+    bool hwCounters = false;
+    bool memory = false;
+    std::string tracePath; // non-empty: record spans and write a Chrome trace here
+    OutputFormat format = OutputFormat::Text;
+    std::string outPath; // empty = stdout
+};
+
+struct SampleStats {
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p95 = 0.0;
+    double min = 0.0;
+};
+
+// One input x container x strategy x partition mode x cache mode x thread count combination.
+struct BenchCase {
+    std::string input;
+    ContainerKind container = ContainerKind::Vector;
+    SplitStrategy strategy = SplitStrategy::Strategy1_CopyToTwoContainers;
+    PartitionMode pmode = PartitionMode::Partition;
+    CacheControl::CacheMode cacheMode = CacheControl::CacheMode::AsIs;
+    unsigned threads = 1; // Analyzer::threads() during the runs
+    double residentBefore = -1.0; // page-cache residency of the input before the last run, -1 if unknown
+    std::vector<PerfResult> samples; // measured repetitions only
+};
+
+std::string containerName(ContainerKind c);
+
+SampleStats summarize(std::vector<double> samples);
+
+// Stage names in report order: read, sort, split, write, total.
+const std::vector<std::string>& stageNames();
+double stageValue(const PerfResult& r, std::size_t stage);
+std::vector<double> stageSamples(const BenchCase& c, std::size_t stage);
+
+// Median of each counter over the repetitions ("total" sums the four stages).
+HwCounters stageCounters(const BenchCase& c, std::size_t stage);
+
+// Median memory figures over the repetitions ("total" sums allocations and
+// takes the largest peaks). Invalid unless memory tracking was on.
+MemStats stageMemory(const BenchCase& c, std::size_t stage);
+
+std::vector<BenchCase> run(const BenchConfig& cfg);
+
+void report(std::ostream& out, const std::vector<BenchCase>& cases, OutputFormat format);
+
+// 1, 2, 4, ... up to maxThreads (0 = hardware threads), always ending at maxThreads.
+std::vector<unsigned> sweepThreadCounts(unsigned maxThreads);
+
+// Scaling of one stage at one thread count against the lowest thread count
+// of the same input/container/strategy/partition/cache combination. Ratios
+// stay 0 when either run skipped the stage.
+struct ScalingPoint {
+    double medianMs = 0.0;
+    double speedup = 0.0;
+    double efficiency = 0.0;  // speedup per added thread (speedup * baseThreads / threads)
+    double recordsPerSec = 0.0;
+};
+
+ScalingPoint scaling(const BenchCase& base, const BenchCase& c, std::size_t stage);
+
+// Speedup/efficiency/throughput table for cases run at several thread counts.
+void reportScaling(std::ostream& out, const std::vector<BenchCase>& cases, OutputFormat format);
+
+// Parses `bench` arguments (everything after the subcommand); throws ParseException.
+BenchConfig parseArgs(const std::vector<std::string>& args);
+std::string usage();
+
+// `sweep` arguments: bench options with sweep defaults (vector, S2, 1..N
+// threads, the students_<N>.txt files present in data/generated).
+BenchConfig parseSweepArgs(const std::vector<std::string>& args);
+std::string sweepUsage();
+
+} // namespace Benchmark
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CACHECONTROL_H
+#define CACHECONTROL_H
+
+#include <string>
+
+// Page-cache control for input files, so container pipelines can be compared
+// on equal terms instead of the first run paying the disk reads.
+namespace CacheControl {
+
+enum class CacheMode {
+    AsIs, // leave the page cache alone (old behavior)
+    Cold, // evict the input before each run (fdatasync + POSIX_FADV_DONTNEED)
+    Warm  // read the whole input before each run
+};
+
+std::string cacheModeName(CacheMode m);
+CacheMode cacheModeFromName(const std::string& name); // throws ParseException
+
+// Both throw FileException when the file cannot be opened.
+void evict(const std::string& path);
+void prewarm(const std::string& path);
+
+void prepare(const std::string& path, CacheMode mode);
+
+// Fraction of the file's pages currently resident (mincore), or -1 if unknown.
+double residentFraction(const std::string& path);
+
+} // namespace CacheControl
+
+#endif
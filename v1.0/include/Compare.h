@@ -0,0 +1,62 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "Analyzer.h"
+#include "Benchmark.h"
+#include "CacheControl.h"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Cross-version comparison: runs the same Strategy 1 read -> sort -> split ->
+// write workload through the v0.1, v0.2, v0.25 and v1.0 cores on the same
+// input files and reports them side by side.
+//
+// The versions share class and namespace names (Person, Analyzer, ...), so
+// each core is built as its own library and linked into its own driver
+// executable, sgc-compare-<version> (see compare/). Every repetition is one
+// driver process; the page cache is prepared before each.
+namespace Compare {
+
+struct CompareConfig {
+    // File paths, or "gen:<count>[:<profile>]", generated once into a temp file
+    std::vector<std::string> inputs;
+    std::vector<std::string> versions = {"v0.1", "v0.2", "v0.25", "v1.0"};
+    std::vector<std::string> containers = {"vector", "deque", "list"};
+    CacheControl::CacheMode cacheMode = CacheControl::CacheMode::Warm;
+    int warmup = 1;
+    int repetitions = 3;
+    Benchmark::OutputFormat format = Benchmark::OutputFormat::Text;
+    std::string outPath;   // empty = stdout
+    std::string driverDir; // empty = the directory of this executable
+};
+
+// One input x container x version combination.
+struct CompareCase {
+    std::string input;
+    std::string container;
+    std::string version;
+    bool supported = true;  // false: the version has no such container
+    std::size_t passed = 0; // records in the passed file of the last run
+    std::vector<PerfResult> samples; // measured repetitions only
+};
+
+const std::vector<std::string>& knownVersions();
+
+// Driver executable of a version: <dir>/sgc-compare-<version>
+std::string driverPath(const std::string& dir, const std::string& version);
+
+std::vector<CompareCase> run(const CompareConfig& cfg);
+
+// Per input and container, one row per version with the median stage times
+// and the speedup over the first version in the list that has the container.
+void report(std::ostream& out, const std::vector<CompareCase>& cases, Benchmark::OutputFormat format);
+
+// Parses `compare` arguments (everything after the subcommand); throws ParseException.
+CompareConfig parseArgs(const std::vector<std::string>& args);
+std::string usage();
+
+} // namespace Compare
+
+#endif
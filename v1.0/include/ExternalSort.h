@@ -0,0 +1,85 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Sort-and-split for inputs larger than memory. Records are read until the
+// memory budget is reached, sorted as the pipelines sort (Sorter::order()),
+// and spilled as a run to a temporary directory; the runs are then merged
+// through a loser tree straight into the passed and failed files. An input
+// that fits the budget is never spilled.
+namespace ExternalSort {
+
+// Text runs are student lines as the pipelines write them; binary runs
+// store the fields as varints and length-prefixed names, which is a little
+// smaller than text and decodes without parsing digits.
+enum class RunFormat { Text, Binary };
+
+RunFormat runFormatFromName(const std::string& name); // throws ParseException
+const char* runFormatName(RunFormat f);
+
+// "512M", "4G", "65536": bytes with an optional K/M/G suffix (powers of
+// 1024). Throws ParseException.
+std::size_t sizeFromText(const std::string& text);
+
+struct Config {
+    // Estimated bytes of records held while building one run; also what the
+    // merge's read buffers may use. Less than MIN_MEMORY counts as MIN_MEMORY.
+    std::size_t memoryBytes = std::size_t{1} << 30;
+    std::string tempDir; // empty = the system temp directory
+    RunFormat runFormat = RunFormat::Binary;
+    unsigned threads = 1; // for sorting each run
+};
+
+struct Result {
+    std::uint64_t records = 0;
+    std::uint64_t passed = 0;
+    std::size_t runs = 0;        // sorted runs; spilledBytes is 0 when the input fit in one
+    std::size_t mergePasses = 0; // intermediate passes before the final merge
+    std::uint64_t spilledBytes = 0;
+    double runMs = 0.0;   // read, sort and spill
+    double mergeMs = 0.0; // every merge pass, writing the outputs included
+};
+
+// Reads every input in order and writes the sorted passed / failed students.
+// The temporary runs live in their own directory under cfg.tempDir, removed
+// afterwards. Throws FileException.
+Result sortFiles(const std::vector<std::string>& inputs, const std::string& outPass, const std::string& outFail,
+                 const Config& cfg);
+
+// Merges student files that are each sorted in Sorter::order() into out,
+// through the same loser tree; equal students keep the order of the inputs.
+// At most MAX_FAN_IN inputs. Returns the records written. Throws FileException.
+std::uint64_t mergeSortedFiles(const std::vector<std::string>& inputs, const std::string& out);
+
+// A fresh directory named <prefix>-<pid>-<n> under parent (empty = the
+// system temp directory), removed with everything in it.
+class TempDir {
+public:
+    explicit TempDir(const std::string& parent, const std::string& prefix = "sgc-sort");
+    ~TempDir();
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    std::string path() const { return path_.string(); }
+    std::string file(const std::string& name) const { return (path_ / name).string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+// Widest merge: past this many runs they are merged in groups first.
+inline constexpr std::size_t MAX_FAN_IN = 512;
+// Read buffer per run during a merge, before the budget is shared out
+inline constexpr std::size_t MIN_MERGE_BLOCK = 64 << 10;
+inline constexpr std::size_t MAX_MERGE_BLOCK = 4 << 20;
+// Smallest budget: one merge block, so a run is never a handful of records
+inline constexpr std::size_t MIN_MEMORY = MIN_MERGE_BLOCK;
+
+} // namespace ExternalSort
+
+#endif
@@ -1,20 +1,94 @@
 #ifndef FILEGENERATOR_H
 #define FILEGENERATOR_H
 
+#include "Student.h"
 #include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
 namespace FileGenerator {
 
+constexpr std::uint64_t DEFAULT_SEED = 0x5EEDC0FFEEULL;
+
+// Named synthetic workloads. Uniform is the original NameN SurnameN file with
+// uniform 0..10 grades; the rest skew one distribution each, except Realistic
+// which mixes several and Students which mirrors the padded data/Students layout.
+enum class WorkloadProfile {
+    Uniform,
+    SkewedPass,        // ~90% pass
+    SkewedFail,        // ~10% pass
+    VariableHomework,  // 0..2*hwPerStudent homework grades per record
+    LongNames,         // 20..80 byte names and surnames
+    Utf8Names,         // multi-byte UTF-8 names and surnames
+    DuplicateSurnames, // surnames drawn from a pool of 100
+    Sorted,            // already in descending final-grade order
+    NearlySorted,      // sorted, with ~1% of records displaced
+    Students,          // VardasN PavardeN, padded columns
+    Realistic          // 80% pass, variable homework, mixed names, duplicate surnames
+};
+
+// Every record draws from its own counter-based stream keyed by (seed, record
+// number), so the output depends only on the seed, never on the thread count.
+struct GeneratorOptions {
+    int hwPerStudent = 5;
+    std::uint64_t seed = DEFAULT_SEED;
+    unsigned threads = 0; // 0 = std::thread::hardware_concurrency()
+    WorkloadProfile profile = WorkloadProfile::Uniform;
+    // data/Students fixed-width columns (always on for Students). No header
+    // line: every reader would take it for a student.
+    bool paddedLayout = false;
+};
+
+std::string profileName(WorkloadProfile p);
+WorkloadProfile profileFromName(const std::string& name); // throws GeneratorException
+std::vector<WorkloadProfile> allProfiles();
+
+// outPath "-" streams to stdout; a FIFO path works like any other file.
 void generateFile(const std::string& outPath,
                   std::uint64_t count,
                   int hwPerStudent = 5);
 
+void generateFile(const std::string& outPath,
+                  std::uint64_t count,
+                  const GeneratorOptions& opts);
+
+// Streaming writer behind generateFile: same bytes, any ostream.
+void writeRecords(std::ostream& out,
+                  std::uint64_t count,
+                  const GeneratorOptions& opts);
+
 void generateFilesForCounts(const std::string& folder,
                             const std::vector<std::uint64_t>& counts,
                             int hwPerStudent = 5);
 
+// Non-uniform profiles write into folder/<profile name>/students_N.txt so the
+// default students_N.txt set is never overwritten.
+void generateFilesForCounts(const std::string& folder,
+                            const std::vector<std::uint64_t>& counts,
+                            const GeneratorOptions& opts);
+
+// Pull-based, in-memory view of generateFile's output: yields the same records
+// (same seed, same profile) as Student objects, with no text round trip.
+class RecordSource {
+public:
+    explicit RecordSource(std::uint64_t count, const GeneratorOptions& opts = GeneratorOptions{});
+
+    bool next(Student& out); // false once all records were produced
+
+    // Appends up to max records to out (generated in parallel); returns how many.
+    std::size_t nextBatch(std::vector<Student>& out, std::size_t max);
+
+    std::uint64_t size() const { return count_; }
+    std::uint64_t remaining() const { return count_ - (next_ - 1); }
+    void reset() { next_ = 1; }
+
+private:
+    std::uint64_t count_;
+    GeneratorOptions opts_;
+    std::uint64_t next_ = 1;
+};
+
 } // namespace FileGenerator
 
 #endif
@@ -0,0 +1,79 @@
+#ifndef GRADESTATS_H
+#define GRADESTATS_H
+
+#include "Benchmark.h"
+#include "RecordScanner.h"
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Exact grade distribution of student files in one streaming pass.
+//
+// Final grades take few distinct values: with n homework grades summing to
+// S and exam E, finalAvg = (2S + 3En) / 5n and finalMed = (M + 3E) / 5, where
+// M is twice the homework median (an integer). Each record therefore adds one
+// count to a bin keyed by an exact fraction, so a histogram is a few hundred
+// bins however many records it holds. Histograms of file slices and of
+// different files merge by adding counts, and every statistic below comes
+// from the bins: no record is kept and nothing is sorted.
+namespace GradeStats {
+
+// num / den in lowest terms, den > 0; ordered by value
+struct Grade {
+    std::int64_t num = 0;
+    std::int64_t den = 1;
+
+    double value() const { return static_cast<double>(num) / static_cast<double>(den); }
+};
+
+bool operator<(const Grade& a, const Grade& b);
+bool operator==(const Grade& a, const Grade& b);
+
+Grade finalAvgGrade(long long homeworkSum, std::size_t homeworkCount, int exam);
+Grade finalMedGrade(long long twiceMedian, int exam);
+
+class Histogram {
+public:
+    void add(const Grade& g, std::uint64_t n = 1);
+    void merge(const Histogram& other);
+
+    std::uint64_t count() const { return count_; }
+    const std::map<Grade, std::uint64_t>& bins() const { return bins_; }
+
+    // All of these need count() > 0.
+    Grade min() const { return bins_.begin()->first; }
+    Grade max() const { return bins_.rbegin()->first; }
+    Grade percentile(double p) const; // nearest rank, p in (0, 100]
+    double mean() const;
+    double stddev() const; // population
+
+private:
+    std::map<Grade, std::uint64_t> bins_;
+    std::uint64_t count_ = 0;
+};
+
+struct Stats {
+    std::uint64_t records = 0;
+    std::uint64_t passed = 0; // finalAvg >= Pipeline::PASS_CUTOFF, decided as the pipelines do
+    Histogram finalAvg;
+    Histogram finalMed;
+
+    void add(const RecordScanner::Record& r);
+    void merge(const Stats& other);
+};
+
+// Each file is cut into `threads` line-aligned ranges that are scanned
+// concurrently into their own Stats and merged. Throws FileException.
+Stats scanFile(const std::string& path, unsigned threads = 1);
+Stats scanFiles(const std::vector<std::string>& paths, unsigned threads = 1);
+
+// text: summary table and per-point bands; json: summary and every bin;
+// csv: one row per bin (series,num,den,value,count).
+void report(std::ostream& out, const std::vector<std::string>& inputs, const Stats& stats,
+            Benchmark::OutputFormat format);
+
+} // namespace GradeStats
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef INCREMENTALDATASET_H
+#define INCREMENTALDATASET_H
+
+#include "Student.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Students kept in descending final grade order under single-record edits.
+// The records live in an order-statistics tree (libstdc++'s policy-based
+// red-black tree, each node also storing its subtree size), keyed by (final
+// grade descending, id), so add, regrade and remove are O(log n) and so are
+// rank, select-by-rank and percentile queries. Passed students are exactly
+// the tree's prefix with grade >= Pipeline::PASS_CUTOFF, and the pass count
+// is kept alongside: no edit ever needs a re-sort or re-partition. The tree
+// stays in IncrementalDataset.cpp, so includers do not depend on libstdc++.
+class IncrementalDataset {
+public:
+    using Id = std::uint64_t;
+
+    IncrementalDataset();
+    ~IncrementalDataset();
+    IncrementalDataset(IncrementalDataset&&) noexcept;
+    IncrementalDataset& operator=(IncrementalDataset&&) noexcept;
+
+    Id add(Student s);
+    // New grades for an existing student; false when the id is unknown.
+    bool update(Id id, const std::vector<int>& homework, int exam);
+    bool remove(Id id);
+
+    std::size_t size() const;
+    std::size_t passed() const;
+    std::size_t failed() const { return size() - passed(); }
+
+    const Student* find(Id id) const;
+    std::size_t rankOf(Id id) const;              // 0 = best; needs a known id
+    const Student& byRank(std::size_t rank) const; // rank < size()
+    Id idAt(std::size_t rank) const;               // rank < size()
+    double percentile(double p) const;             // nearest rank, p in (0, 100]; 0 when empty
+
+    // In descending grade order: f(id, student)
+    void forEachPassed(const std::function<void(Id, const Student&)>& f) const;
+    void forEachFailed(const std::function<void(Id, const Student&)>& f) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include <cstdint>
+
+// Heap and RSS usage of one pipeline stage.
+struct MemStats {
+    bool valid = false;
+    std::uint64_t allocations = 0;     // operator new calls
+    std::uint64_t bytesAllocated = 0;  // bytes requested from operator new
+    std::uint64_t peakLiveBytes = 0;   // heap high-water mark above the level at stage start
+    std::uint64_t peakRssKb = 0;       // process peak RSS during the stage (VmHWM)
+};
+
+// Counting global operator new/delete (compiled in with SGC_ALLOC_TRACKING).
+// Counting only happens while enabled, so the default cost is one relaxed load
+// per allocation.
+namespace MemoryTracker {
+
+// Off by default; SGC_MEM_TRACKING=1 in the environment or setEnabled(true) turns it on.
+bool enabled();
+void setEnabled(bool on);
+
+// true when the counting operator new/delete is linked in
+bool hooksInstalled();
+
+// Measures one stage. Stages must not overlap: starting a scope resets the
+// global peak-live and peak-RSS marks.
+class Scope {
+public:
+    Scope();
+    MemStats stop();
+
+private:
+    std::uint64_t allocations_ = 0;
+    std::uint64_t bytes_ = 0;
+    std::int64_t liveAtStart_ = 0;
+};
+
+} // namespace MemoryTracker
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include "Student.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Open-addressing hash index from (name, surname) to record position.
+//
+// - one 8-byte slot per record: 32-bit hash tag | position + 1 (0 = empty),
+//   linear probing, load factor at most 0.7, so 12-23 bytes per record
+// - duplicate names are separate slots in the same probe run; lookups
+//   return every match, in position order
+// - built concurrently: slots are claimed with compare-exchange, so the
+//   threads share one table without locks
+// - findBatch hashes a group of keys and prefetches their slots and records
+//   before comparing any strings, so the cache misses overlap
+//
+// The index keeps a pointer to the vector's elements: it stays valid while
+// the vector is neither resized nor destroyed (moving the vector is fine).
+class NameIndex {
+public:
+    struct Key {
+        std::string_view name;
+        std::string_view surname;
+    };
+
+    // Matches of keys[i] are positions[offsets[i] .. offsets[i + 1]).
+    struct BatchResult {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> positions;
+    };
+
+    NameIndex() = default;
+    // Throws FileException at 2^32 - 1 records or more.
+    explicit NameIndex(const std::vector<Student>& students, unsigned threads = 1);
+
+    std::vector<std::uint32_t> find(std::string_view name, std::string_view surname) const;
+    BatchResult findBatch(const std::vector<Key>& keys) const;
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return mask_ + 1; }
+    std::size_t memoryBytes() const { return capacity() * sizeof(std::uint64_t); }
+
+private:
+    static std::uint64_t hashKey(std::string_view name, std::string_view surname);
+
+    template <typename F>
+    void probe(const Key& key, std::uint64_t hash, F onMatch) const;
+
+    const Student* records_ = nullptr;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+    std::uint64_t mask_ = 0;
+    std::size_t size_ = 0;
+};
+
+#endif
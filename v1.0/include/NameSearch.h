@@ -0,0 +1,66 @@
+#ifndef NAMESEARCH_H
+#define NAMESEARCH_H
+
+#include "Student.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Prefix and substring search over names and surnames: a trigram inverted
+// index. Each field is indexed as "\n<field>", so every trigram of a record
+// has a posting list of record positions, and a prefix search is a substring
+// search for "\n<prefix>". A query intersects the posting lists of the
+// pattern's trigrams, shortest first, and checks the few candidates left;
+// patterns too short to contain a trigram fall back to a full scan.
+//
+// - trigrams are numbered over the bytes that occur in the names (alphabet
+//   size A), so the list offsets are one flat array of A^3 + 1 entries
+// - built by a two-pass counting sort, split over threads by record range;
+//   posting lists come out ascending without sorting
+// - memory: 4 bytes per distinct trigram per record (about 20 for short
+//   names) plus the offsets
+//
+// Like NameIndex, it keeps a pointer to the vector's elements.
+class NameSearch {
+public:
+    enum class Field { Any, Name, Surname };
+
+    NameSearch() = default;
+    // Throws FileException when the index would exceed 2^32 postings.
+    explicit NameSearch(const std::vector<Student>& students, unsigned threads = 1);
+
+    // Positions of the matching records, ascending, each record once.
+    // Patterns containing whitespace match nothing.
+    std::vector<std::uint32_t> findSubstring(std::string_view pattern, Field field = Field::Any) const;
+    std::vector<std::uint32_t> findPrefix(std::string_view prefix, Field field = Field::Any) const;
+
+    std::size_t size() const { return size_; }
+    std::size_t memoryBytes() const;
+
+    // The same queries as a full scan, for checking the index.
+    static std::vector<std::uint32_t> scanSubstring(const std::vector<Student>& students, std::string_view pattern,
+                                                    Field field = Field::Any);
+    static std::vector<std::uint32_t> scanPrefix(const std::vector<Student>& students, std::string_view prefix,
+                                                 Field field = Field::Any);
+
+private:
+    std::vector<std::uint32_t> find(std::string_view pattern, bool prefix, Field field) const;
+
+    template <typename F>
+    void forEachTrigram(const Student& s, std::vector<std::uint32_t>& scratch, F f) const;
+
+    const Student* records_ = nullptr;
+    std::size_t size_ = 0;
+    std::array<std::uint8_t, 256> symbol_{}; // byte -> alphabet index + 1, 0 = never seen
+    std::uint32_t alphabet_ = 0;
+    std::vector<std::uint32_t> offsets_;     // trigram -> start in postings_
+    std::vector<std::uint32_t> postings_;    // record positions, ascending per trigram
+};
+
+// "any", "name" or "surname"; throws ParseException otherwise
+NameSearch::Field searchFieldFromName(const std::string& name);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hardware/software counters for one pipeline stage. Any counter the kernel
+// refuses (no PMU, perf_event_paranoid, containers) is simply not present.
+// A counter the PMU shared with others (multiplexed) counted only part of
+// the stage; its value is scaled up by enabled / running time.
+struct HwCounters {
+    enum Counter { Cycles, Instructions, L1dMisses, LlcMisses, BranchMisses, PageFaults, COUNT };
+
+    std::array<std::uint64_t, COUNT> value{};
+    std::array<bool, COUNT> present{};
+    std::array<bool, COUNT> multiplexed{};
+
+    bool any() const;
+    bool anyMultiplexed() const;
+    static const char* name(std::size_t c);
+};
+
+namespace PerfCounters {
+
+// Off by default; SGC_HW_COUNTERS=1 in the environment or setEnabled(true) turns it on.
+bool enabled();
+void setEnabled(bool on);
+
+// Counts the calling thread and any thread it spawns while running (inherit),
+// via one perf_event_open fd per counter.
+class CounterGroup {
+public:
+    CounterGroup();
+    ~CounterGroup();
+    CounterGroup(const CounterGroup&) = delete;
+    CounterGroup& operator=(const CounterGroup&) = delete;
+
+    bool available() const;
+    void start();
+    HwCounters stop();
+
+private:
+    std::array<int, HwCounters::COUNT> fds_;
+};
+
+} // namespace PerfCounters
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Analyzer.h"
+#include "ExceptionHandlers.h"
+#include "FileGenerator.h"
+#include "PoolAllocator.h"
+#include "Sorter.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Container-agnostic read -> sort -> split -> write pipeline over any
+// sequence container of Student. The Analyzer vector/deque/list functions are
+// instantiations of these templates; other containers (std::pmr::vector, a
+// chunked vector, ...) plug in the same way and run through the same stages.
+//
+// ContainerOps<C> is the customization point for the container-specific
+// steps: sort and the two split strategies. The primary template serves
+// random-access sequences; std::list (with any allocator) has its own
+// specialization.
+namespace Pipeline {
+
+inline constexpr double PASS_CUTOFF = 5.0;
+
+inline bool isPassed(const Student& s) {
+    return s.finalAvgCached() >= PASS_CUTOFF;
+}
+
+// Runs f(0) .. f(parts - 1), part 0 on the calling thread.
+template <typename F>
+void runParts(unsigned parts, const char* threadName, F f) {
+    std::vector<std::thread> pool;
+    for (unsigned k = 1; k < parts; ++k) {
+        pool.emplace_back([&f, k, threadName] {
+            Trace::setThreadName(threadName);
+            f(k);
+        });
+    }
+    f(0);
+    for (auto& t : pool) t.join();
+}
+
+// Capacity-managed containers (vector-like) get reserve/shrink_to_fit calls.
+template <typename C, typename = void>
+struct HasReserve : std::false_type {};
+template <typename C>
+struct HasReserve<C, std::void_t<decltype(std::declval<C&>().reserve(std::size_t{}))>> : std::true_type {};
+
+template <typename C>
+void reserveFor(C& c, std::size_t n) {
+    if constexpr (HasReserve<C>::value) c.reserve(n);
+}
+
+// Times one pipeline stage and emits it as a trace span; with PerfCounters /
+// MemoryTracker enabled it also records the stage's hardware counters and
+// heap/RSS usage into r.
+class StageProbe {
+public:
+    StageProbe(PerfResult& r, PerfStage stage);
+    double stop();
+
+private:
+    PerfResult& r_;
+    PerfStage stage_;
+    std::unique_ptr<PerfCounters::CounterGroup> counters_;
+    std::unique_ptr<MemoryTracker::Scope> memory_;
+    std::uint64_t start_ = 0;
+};
+
+template <typename It, typename Pred>
+It doPartition(It first, It last, Pred pred, PartitionMode pmode) {
+    return (pmode == PartitionMode::StablePartition)
+        ? std::stable_partition(first, last, pred)
+        : std::partition(first, last, pred);
+}
+
+// -------------------- SPLIT / SORT CUSTOMIZATION --------------------
+
+// Strategy 1: copy into two new containers; the input stays unchanged.
+template <typename C>
+void copySplit(const C& students, C& passed, C& failed) {
+    passed.clear();
+    failed.clear();
+    reserveFor(passed, students.size() / 2);
+    reserveFor(failed, students.size() / 2);
+
+    std::remove_copy_if(students.begin(), students.end(), std::back_inserter(failed),
+                        [](const Student& s) { return isPassed(s); });
+    std::remove_copy_if(students.begin(), students.end(), std::back_inserter(passed),
+                        [](const Student& s) { return !isPassed(s); });
+}
+
+template <typename C>
+struct ContainerOps {
+    static void sort(C& students, unsigned threads) {
+        if (Sorter::order() == Sorter::SortOrder::Total) Sorter::sortRangeTotal(students.begin(), students.end(), threads);
+        else Sorter::sortRangeDesc(students.begin(), students.end(), threads);
+    }
+
+    static void splitCopy(const C& students, C& passed, C& failed) {
+        copySplit(students, passed, failed);
+    }
+
+    // Strategy 2: move the failed tail out; the input keeps the passed students.
+    static void splitMove(C& students, C& failed, PartitionMode pmode) {
+        failed.clear();
+        reserveFor(failed, students.size() / 2);
+
+        auto it = doPartition(students.begin(), students.end(),
+                              [](const Student& s) { return isPassed(s); }, pmode);
+        std::copy(std::make_move_iterator(it), std::make_move_iterator(students.end()),
+                  std::back_inserter(failed));
+        students.erase(it, students.end());
+        if constexpr (HasReserve<C>::value) students.shrink_to_fit();
+    }
+};
+
+template <typename A>
+struct ContainerOps<std::list<Student, A>> {
+    using C = std::list<Student, A>;
+
+    // pooled lists sort through a key array; the plain list keeps list::sort
+    static void sort(C& students, unsigned) {
+        if (Sorter::order() == Sorter::SortOrder::Total) Sorter::sortListTotal(students);
+        else if constexpr (std::is_same_v<A, PoolAllocator<Student>>) Sorter::sortListByKeyDesc(students);
+        else students.sort(Sorter::ByGradeDesc());
+    }
+
+    static void splitCopy(const C& students, C& passed, C& failed) {
+        copySplit(students, passed, failed);
+    }
+
+    // nodes move by splice, nothing is copied
+    static void splitMove(C& students, C& failed, PartitionMode pmode) {
+        failed.clear();
+        auto it = doPartition(students.begin(), students.end(),
+                              [](const Student& s) { return isPassed(s); }, pmode);
+        failed.splice(failed.end(), students, it, students.end());
+    }
+};
+
+// -------------------- READ --------------------
+
+// Appends every valid record of the stream to out.
+template <typename C>
+void parseStream(std::istream& in, C& out) {
+    while (in.good()) {
+        Student s;
+        in >> s;
+        if (!in && in.eof()) break;
+        if (!s.isValidBasic()) continue;
+        out.push_back(std::move(s));
+    }
+}
+
+template <typename C>
+void computeCaches(C& students) {
+    for (auto& s : students) s.computeCache();
+}
+
+// Loads the file in one go, cuts it into `parts` slices at line boundaries and
+// parses each slice on its own thread. Records come back in file order.
+std::vector<std::vector<Student>> parseFileSlices(const std::string& filename, unsigned parts);
+
+template <typename C>
+C readFile(const std::string& filename) {
+    C out;
+    if (Analyzer::threads() > 1) {
+        auto slices = parseFileSlices(filename, Analyzer::threads());
+        std::size_t total = 0;
+        for (const auto& slice : slices) total += slice.size();
+        reserveFor(out, total);
+        for (auto& slice : slices) {
+            std::move(slice.begin(), slice.end(), std::back_inserter(out));
+            std::vector<Student>().swap(slice);
+        }
+        return out;
+    }
+
+    std::ifstream in(filename);
+    if (!in.is_open()) throw FileException("Cannot open file: " + filename);
+    parseStream(in, out);
+    computeCaches(out);
+    return out;
+}
+
+inline constexpr std::size_t SOURCE_BATCH = 1 << 16;
+
+template <typename C>
+C readSource(FileGenerator::RecordSource& src) {
+    C out;
+    if constexpr (std::is_same_v<C, std::vector<Student>>) {
+        out.reserve(static_cast<std::size_t>(src.remaining()));
+        while (src.nextBatch(out, SOURCE_BATCH) > 0) {}
+    } else {
+        reserveFor(out, static_cast<std::size_t>(src.remaining()));
+        std::vector<Student> batch;
+        while (src.nextBatch(batch, SOURCE_BATCH) > 0) {
+            std::move(batch.begin(), batch.end(), std::back_inserter(out));
+            batch.clear();
+        }
+    }
+    return out;
+}
+
+// -------------------- WRITE --------------------
+
+inline constexpr std::size_t WRITE_BLOCK = 1 << 15;
+
+// Each round formats `parts` consecutive blocks of records concurrently,
+// then appends them to the file in order.
+template <typename C>
+void writeParallel(std::ofstream& out, const C& students, unsigned parts) {
+    std::vector<std::string> texts(parts);
+    auto it = students.begin();
+    std::size_t left = students.size();
+
+    while (left > 0) {
+        std::vector<typename C::const_iterator> bounds{it};
+        for (unsigned k = 0; k < parts && left > 0; ++k) {
+            std::size_t n = std::min(left, WRITE_BLOCK);
+            std::advance(it, static_cast<std::ptrdiff_t>(n));
+            left -= n;
+            bounds.push_back(it);
+        }
+
+        const unsigned blocks = static_cast<unsigned>(bounds.size() - 1);
+        runParts(blocks, "format worker", [&](unsigned k) {
+            Trace::Span span("format block", "write");
+            std::ostringstream ss;
+            for (auto s = bounds[k]; s != bounds[k + 1]; ++s) ss << *s << "\n";
+            texts[k] = ss.str();
+        });
+        for (unsigned k = 0; k < blocks; ++k) out.write(texts[k].data(), static_cast<std::streamsize>(texts[k].size()));
+    }
+}
+
+template <typename C>
+void writeFile(const std::string& filename, const C& students) {
+    std::ofstream out(filename);
+    if (!out.is_open()) throw FileException("Cannot open file for writing: " + filename);
+    if (Analyzer::threads() > 1) return writeParallel(out, students, Analyzer::threads());
+    for (const auto& s : students) out << s << "\n";
+}
+
+// -------------------- PIPELINE --------------------
+// The loader returns the filled container, so the same stages run over a
+// file or an in-memory RecordSource. Empty output paths skip the write.
+
+template <typename C, typename Load>
+PerfResult run(Load load, const std::string& outPass, const std::string& outFail,
+               SplitStrategy strat, PartitionMode pmode, const char* spanName = "pipeline") {
+    PerfResult r;
+    Trace::Span pipelineSpan(spanName, "pipeline");
+
+    StageProbe readProbe(r, STAGE_READ);
+    C students = load();
+    r.read_ms = readProbe.stop();
+    r.total_students = students.size();
+
+    StageProbe sortProbe(r, STAGE_SORT);
+    ContainerOps<C>::sort(students, Analyzer::threads());
+    r.sort_ms = sortProbe.stop();
+
+    C passed;
+    C failed;
+
+    StageProbe splitProbe(r, STAGE_SPLIT);
+    if (strat == SplitStrategy::Strategy1_CopyToTwoContainers) {
+        ContainerOps<C>::splitCopy(students, passed, failed);
+    } else {
+        ContainerOps<C>::splitMove(students, failed, pmode);
+        // Base container is now passed students
+        passed = students;
+    }
+    r.split_ms = splitProbe.stop();
+
+    StageProbe writeProbe(r, STAGE_WRITE);
+    if (!outPass.empty()) writeFile(outPass, passed);
+    if (!outFail.empty()) writeFile(outFail, failed);
+    r.write_ms = writeProbe.stop();
+
+    r.total_ms = pipelineSpan.stop();
+    return r;
+}
+
+template <typename C>
+PerfResult runFile(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                   SplitStrategy strat, PartitionMode pmode, const char* spanName = "pipeline") {
+    return run<C>([&] { return readFile<C>(inputFile); }, outPass, outFail, strat, pmode, spanName);
+}
+
+template <typename C>
+PerfResult runSource(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                     SplitStrategy strat, PartitionMode pmode, const char* spanName = "pipeline") {
+    return run<C>([&] { return readSource<C>(src); }, outPass, outFail, strat, pmode, spanName);
+}
+
+} // namespace Pipeline
+
+#endif
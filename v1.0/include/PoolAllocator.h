@@ -0,0 +1,133 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Process-wide pool of fixed-size slots carved out of large contiguous blocks.
+//
+// - fresh slots are handed out in address order, so nodes allocated one after
+//   another (a list filled from a file) sit next to each other in memory
+// - freed slots go on an intrusive free list and are reused first
+// - when the last live slot is freed every block goes back to the heap, so a
+//   finished pipeline leaves nothing behind
+// - one pool per (Size, Align); a spin lock keeps it usable from any thread
+template <std::size_t Size, std::size_t Align>
+class FixedSizePool {
+    static_assert(Align <= alignof(std::max_align_t), "over-aligned slots are not supported");
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    static constexpr std::size_t roundUp(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+public:
+    static constexpr std::size_t SLOT_BYTES = roundUp(Size < sizeof(FreeSlot) ? sizeof(FreeSlot) : Size,
+                                                      Align < alignof(FreeSlot) ? alignof(FreeSlot) : Align);
+    static constexpr std::size_t BLOCK_SLOTS = 4096;
+
+    static FixedSizePool& instance() {
+        static FixedSizePool pool;
+        return pool;
+    }
+
+    void* allocate() {
+        Lock lock(busy_);
+        ++live_;
+        if (free_) {
+            FreeSlot* s = free_;
+            free_ = s->next;
+            return s;
+        }
+        if (bump_ == bumpEnd_) {
+            try {
+                blocks_.push_back(static_cast<char*>(::operator new(SLOT_BYTES * BLOCK_SLOTS)));
+            } catch (...) {
+                --live_;
+                throw;
+            }
+            bump_ = blocks_.back();
+            bumpEnd_ = bump_ + SLOT_BYTES * BLOCK_SLOTS;
+        }
+        void* p = bump_;
+        bump_ += SLOT_BYTES;
+        return p;
+    }
+
+    void deallocate(void* p) noexcept {
+        Lock lock(busy_);
+        auto* s = static_cast<FreeSlot*>(p);
+        s->next = free_;
+        free_ = s;
+        if (--live_ == 0) releaseAll();
+    }
+
+    std::size_t liveSlots() const { return live_; }
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+private:
+    FixedSizePool() = default;
+    ~FixedSizePool() { releaseAll(); }
+
+    struct Lock {
+        explicit Lock(std::atomic_flag& f) : f_(f) {
+            while (f_.test_and_set(std::memory_order_acquire)) {}
+        }
+        ~Lock() { f_.clear(std::memory_order_release); }
+        std::atomic_flag& f_;
+    };
+
+    void releaseAll() noexcept {
+        for (char* b : blocks_) ::operator delete(b);
+        blocks_.clear();
+        free_ = nullptr;
+        bump_ = bumpEnd_ = nullptr;
+    }
+
+    std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+    std::vector<char*> blocks_;
+    FreeSlot* free_ = nullptr;
+    char* bump_ = nullptr;
+    char* bumpEnd_ = nullptr;
+    std::size_t live_ = 0;
+};
+
+// Stateless allocator over FixedSizePool. Single-object requests (list and
+// map nodes) come from the pool of the rebound type; arrays go to the heap.
+// All instances are interchangeable, so lists using it can splice freely.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using Pool = FixedSizePool<sizeof(T), alignof(T)>;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n == 1) return static_cast<T*>(Pool::instance().allocate());
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n == 1) Pool::instance().deallocate(p);
+        else std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    friend bool operator==(const PoolAllocator&, const PoolAllocator<U>&) noexcept { return true; }
+    template <typename U>
+    friend bool operator!=(const PoolAllocator&, const PoolAllocator<U>&) noexcept { return false; }
+};
+
+#endif
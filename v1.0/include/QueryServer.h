@@ -0,0 +1,101 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include "NameIndex.h"
+#include "NameSearch.h"
+#include "Student.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Resident query server: loads student files once and answers queries over a
+// Unix domain socket, so repeated questions no longer re-parse whole files.
+//
+// Protocol: one request per line; every request gets exactly one response
+// (MGET: one per name pair).
+//   GET <name> <surname>   records with that name
+//   MGET <name> <surname> [<name> <surname> ...]
+//                          GET for each pair, one ROWS block per pair
+//   FIND <text>            records whose name or surname contains text
+//   PREFIX <text>          records whose name or surname starts with text
+//   TOP <k>                the k best records (final grade, descending)
+//   SAMPLE <k>             k distinct records drawn at random
+//   COUNT                  OK <total> <passed> <failed>
+//   PCT <p>                OK <grade>, nearest-rank percentile, 0 < p <= 100
+//   PING                   OK
+//   QUIT                   OK, then the server closes the connection
+// Record answers are "ROWS <n>" followed by n lines "<name> <surname> <final>",
+// best final grade first; FIND and PREFIX return at most MAX_ROWS of them.
+// errors are "ERR <message>". Requests may be pipelined.
+namespace QueryServer {
+
+// Largest k accepted by TOP and SAMPLE, and the FIND/PREFIX row limit
+inline constexpr std::size_t MAX_ROWS = 100000;
+
+// Immutable after construction, so any number of threads may query it.
+class Dataset {
+public:
+    explicit Dataset(std::vector<Student> students);
+
+    // Reads and concatenates the files (Analyzer::threads() parse workers).
+    static Dataset load(const std::vector<std::string>& files);
+
+    std::size_t size() const { return students_.size(); }
+    std::size_t passed() const { return passed_; }
+
+    // 0 = best final grade
+    const Student& byRank(std::size_t i) const { return students_[i]; }
+
+    std::vector<const Student*> lookup(const std::string& name, const std::string& surname) const;
+    // lookup for every key at once, one result per key
+    std::vector<std::vector<const Student*>> lookupBatch(const std::vector<NameIndex::Key>& keys) const;
+    // Name or surname search, at most limit records, best final grade first
+    std::vector<const Student*> search(const std::string& text, bool prefix, std::size_t limit) const;
+    double percentile(double p) const; // p in (0, 100]; 0 for an empty dataset
+    std::vector<const Student*> sample(std::size_t k, std::mt19937_64& rng) const;
+
+private:
+    std::vector<Student> students_; // descending final grade
+    NameIndex index_;               // over students_
+    NameSearch search_;             // over students_
+    std::size_t passed_ = 0;
+};
+
+// Answers one request line (without the newline), appending the response to
+// out. Returns false when the client asked to close the connection.
+bool handle(const Dataset& data, const std::string& line, std::string& out);
+
+struct ServerConfig {
+    std::string socketPath = "sgc.sock";
+    unsigned workers = 0; // 0 = std::thread::hardware_concurrency()
+};
+
+// Serves until SIGINT/SIGTERM or stop(); throws FileException when the socket
+// cannot be set up. A stale socket file at the path is replaced and the file
+// is removed again on exit.
+void serve(const Dataset& data, const ServerConfig& cfg);
+void stop();
+
+// Blocking client for one connection.
+class Client {
+public:
+    explicit Client(const std::string& socketPath); // throws FileException
+    ~Client();
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    // Sends one request line and returns the whole response, newlines included.
+    std::string request(const std::string& line);
+
+private:
+    std::string readLine();
+
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+} // namespace QueryServer
+
+#endif
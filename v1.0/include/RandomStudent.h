@@ -0,0 +1,59 @@
+#ifndef RANDOMSTUDENT_H
+#define RANDOMSTUDENT_H
+
+#include "Student.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Random students from files without loading them. Both ways draw over all
+// records of all the files given: every record is equally likely, however
+// the records are spread across files of different sizes.
+namespace RandomStudent {
+
+// One pass of reservoir sampling (Li's Algorithm L) over the files in order:
+// k distinct records, every k-subset equally likely, returned in random
+// order; fewer when the files hold fewer. Between replacements a line is only
+// checked for a name and surname; records are parsed when they enter the
+// reservoir. Throws FileException.
+std::vector<Student> reservoir(const std::vector<std::string>& files, std::size_t k, std::mt19937_64& rng);
+
+// Byte offsets of a file's records, persisted next to it in <file>.idx, so
+// record i is one 8-byte read in the index plus one seek and one line parse
+// in the file. The index records the file's size and modification time and
+// is rebuilt by a scan (threads line-aligned ranges) when it is missing or
+// either changed; when it cannot be written the offsets stay in memory.
+class LineIndex {
+public:
+    // Throws FileException.
+    explicit LineIndex(const std::string& file, unsigned threads = 1);
+
+    static std::string pathFor(const std::string& file) { return file + ".idx"; }
+
+    std::uint64_t size() const { return count_; }
+    bool built() const { return built_; } // scanned now rather than loaded
+
+    std::uint64_t offset(std::uint64_t i) const; // i < size()
+    Student at(std::uint64_t i) const;           // i < size(); throws FileException
+
+private:
+    void build(unsigned threads, std::uint64_t fileSize, std::int64_t mtime);
+
+    std::string file_;
+    std::uint64_t count_ = 0;
+    bool built_ = false;
+    std::vector<std::uint64_t> offsets_; // only when the index could not be written
+    mutable std::ifstream idx_;
+    mutable std::ifstream data_;
+};
+
+// k distinct records through the files' indexes: Floyd's algorithm picks k
+// global record numbers out of the summed counts, each is one lookup.
+std::vector<Student> indexed(const std::vector<LineIndex>& indexes, std::size_t k, std::mt19937_64& rng);
+
+} // namespace RandomStudent
+
+#endif
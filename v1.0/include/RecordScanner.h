@@ -0,0 +1,95 @@
+#ifndef RECORDSCANNER_H
+#define RECORDSCANNER_H
+
+#include "ExceptionHandlers.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming access to student files for passes that only need each record's
+// fields once: lines are parsed in place, the way Person's operator>> reads
+// them, without building a Student or holding the file in memory.
+namespace RecordScanner {
+
+// One parsed line; the views point into the line being scanned.
+struct Record {
+    std::string_view name;
+    std::string_view surname;
+    std::vector<int> homework; // storage reused from line to line
+    int exam = 0;
+
+    long long homeworkSum() const;
+    double finalAvg() const; // the same arithmetic as Person::finalAvg, bit for bit
+};
+
+// Fills r from one line (no newline). False when Person would reject it too:
+// an empty line or a missing name or surname. Grades stop at the first token
+// that is not an integer; the last one read is the exam.
+bool parseLine(std::string_view line, Record& r);
+
+// parts + 1 byte offsets cutting the file into parts ranges that start on
+// line boundaries (ranges may be empty). Throws FileException.
+std::vector<std::uint64_t> lineBounds(const std::string& path, unsigned parts);
+
+inline constexpr std::size_t READ_BLOCK = 1 << 20;
+
+// The student files of a folder, sorted: regular *.txt files, without the
+// pipelines' own *.passed.txt / *.failed.txt outputs. Throws FileException.
+std::vector<std::string> folderFiles(const std::string& folder);
+
+// Calls f(std::uint64_t offset, std::string_view line) for every line
+// starting in [begin, end), reading READ_BLOCK bytes at a time. Throws
+// FileException.
+template <typename F>
+void forEachLineAt(const std::string& path, std::uint64_t begin, std::uint64_t end, F f) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) throw FileException("Cannot open file: " + path);
+    in.seekg(static_cast<std::streamoff>(begin));
+
+    std::string buf;
+    std::uint64_t pos = begin; // file offset of buf[0]
+    std::size_t start = 0;     // first unconsumed byte in buf
+    bool eof = false;
+    while (pos + start < end) {
+        std::size_t nl = buf.find('\n', start);
+        if (nl == std::string::npos) {
+            if (eof) { // last line without a newline
+                if (start < buf.size()) f(pos + start, std::string_view(buf).substr(start));
+                break;
+            }
+            buf.erase(0, start);
+            pos += start;
+            start = 0;
+            const std::size_t have = buf.size();
+            buf.resize(have + READ_BLOCK);
+            in.read(&buf[have], static_cast<std::streamsize>(READ_BLOCK));
+            buf.resize(have + static_cast<std::size_t>(in.gcount()));
+            eof = in.gcount() < static_cast<std::streamsize>(READ_BLOCK);
+            continue;
+        }
+        f(pos + start, std::string_view(buf).substr(start, nl - start));
+        start = nl + 1;
+    }
+}
+
+// forEachLineAt without the offsets: f(std::string_view line).
+template <typename F>
+void forEachLine(const std::string& path, std::uint64_t begin, std::uint64_t end, F f) {
+    forEachLineAt(path, begin, end, [&](std::uint64_t, std::string_view line) { f(line); });
+}
+
+// Calls f(const Record&) for every record that starts in [begin, end).
+template <typename F>
+void forEachRecord(const std::string& path, std::uint64_t begin, std::uint64_t end, F f) {
+    Record r;
+    forEachLine(path, begin, end, [&](std::string_view line) {
+        if (parseLine(line, r)) f(static_cast<const Record&>(r));
+    });
+}
+
+} // namespace RecordScanner
+
+#endif
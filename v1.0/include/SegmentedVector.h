@@ -0,0 +1,211 @@
+#ifndef SEGMENTEDVECTOR_H
+#define SEGMENTEDVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Sequence stored in fixed-size blocks of BlockElems elements.
+//
+// - growth allocates one more block; existing elements are never copied or
+//   moved, so references and pointers stay valid until erased
+// - iterators are random access (std::sort, std::partition, std::inplace_merge)
+//   and stay valid across push_back, since they hold an index, not a pointer
+// - erasing a tail (Strategy 2) only destroys the erased elements; the kept
+//   part is not touched and no storage is reallocated
+template <typename T, std::size_t BlockElems = 4096>
+class SegmentedVector {
+    static_assert(BlockElems > 0 && (BlockElems & (BlockElems - 1)) == 0, "BlockElems must be a power of two");
+
+    static constexpr std::size_t shiftFor(std::size_t n) { return n <= 1 ? 0 : 1 + shiftFor(n / 2); }
+    static constexpr std::size_t SHIFT = shiftFor(BlockElems);
+    static constexpr std::size_t MASK = BlockElems - 1;
+
+    template <bool Const>
+    class Iter {
+        using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iter() = default;
+        Iter(Owner* owner, std::size_t i) : owner_(owner), i_(i) {}
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iter(const Iter<false>& other) : owner_(other.owner_), i_(other.i_) {}
+
+        reference operator*() const { return (*owner_)[i_]; }
+        pointer operator->() const { return &(*owner_)[i_]; }
+        reference operator[](difference_type n) const { return (*owner_)[i_ + static_cast<std::size_t>(n)]; }
+
+        Iter& operator++() { ++i_; return *this; }
+        Iter& operator--() { --i_; return *this; }
+        Iter operator++(int) { Iter t = *this; ++i_; return t; }
+        Iter operator--(int) { Iter t = *this; --i_; return t; }
+        Iter& operator+=(difference_type n) { i_ += static_cast<std::size_t>(n); return *this; }
+        Iter& operator-=(difference_type n) { i_ -= static_cast<std::size_t>(n); return *this; }
+        friend Iter operator+(Iter it, difference_type n) { return it += n; }
+        friend Iter operator+(difference_type n, Iter it) { return it += n; }
+        friend Iter operator-(Iter it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const Iter& a, const Iter& b) {
+            return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+        }
+
+        friend bool operator==(const Iter& a, const Iter& b) { return a.i_ == b.i_; }
+        friend bool operator!=(const Iter& a, const Iter& b) { return a.i_ != b.i_; }
+        friend bool operator<(const Iter& a, const Iter& b) { return a.i_ < b.i_; }
+        friend bool operator>(const Iter& a, const Iter& b) { return a.i_ > b.i_; }
+        friend bool operator<=(const Iter& a, const Iter& b) { return a.i_ <= b.i_; }
+        friend bool operator>=(const Iter& a, const Iter& b) { return a.i_ >= b.i_; }
+
+        std::size_t index() const { return i_; }
+
+    private:
+        friend class Iter<!Const>;
+        Owner* owner_ = nullptr;
+        std::size_t i_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    static constexpr std::size_t block_elements = BlockElems;
+
+    SegmentedVector() = default;
+
+    // Both delegate to the default constructor, so the destructor cleans up
+    // when a block allocation or an element copy throws part way.
+    template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    SegmentedVector(InputIt first, InputIt last) : SegmentedVector() {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    SegmentedVector(const SegmentedVector& other) : SegmentedVector() {
+        reserve(other.size_);
+        for (const auto& x : other) push_back(x);
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept { swap(other); }
+
+    SegmentedVector& operator=(const SegmentedVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            for (const auto& x : other) push_back(x);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& other) noexcept {
+        SegmentedVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        clear();
+        for (T* b : blocks_) freeBlock(b);
+    }
+
+    void swap(SegmentedVector& other) noexcept {
+        blocks_.swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t capacity() const { return blocks_.size() * BlockElems; }
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    T& operator[](std::size_t i) { return blocks_[i >> SHIFT][i & MASK]; }
+    const T& operator[](std::size_t i) const { return blocks_[i >> SHIFT][i & MASK]; }
+    T& front() { return (*this)[0]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    void reserve(std::size_t n) {
+        while (capacity() < n) addBlock();
+    }
+
+    // Frees whole blocks beyond the last element.
+    void shrink_to_fit() {
+        const std::size_t needed = (size_ + MASK) >> SHIFT;
+        while (blocks_.size() > needed) {
+            freeBlock(blocks_.back());
+            blocks_.pop_back();
+        }
+        blocks_.shrink_to_fit();
+    }
+
+    void push_back(const T& x) { emplace_back(x); }
+    void push_back(T&& x) { emplace_back(std::move(x)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity()) addBlock();
+        T* slot = &blocks_[size_ >> SHIFT][size_ & MASK];
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void pop_back() {
+        --size_;
+        std::destroy_at(&(*this)[size_]);
+    }
+
+    void clear() { truncate(0); }
+
+    // Destroys elements [n, size()); blocks stay allocated for reuse.
+    void truncate(std::size_t n) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (std::size_t i = n; i < size_; ++i) std::destroy_at(&(*this)[i]);
+        }
+        if (n < size_) size_ = n;
+    }
+
+    // A tail range is dropped in place; any other range shifts the rest down first.
+    iterator erase(const_iterator first, const_iterator last) {
+        const std::size_t lo = first.index();
+        const std::size_t hi = last.index();
+        if (hi != size_) std::move(begin() + static_cast<difference_type>(hi), end(), begin() + static_cast<difference_type>(lo));
+        truncate(size_ - (hi - lo));
+        return iterator(this, lo);
+    }
+
+private:
+    static T* allocateBlock() { return std::allocator<T>().allocate(BlockElems); }
+    static void freeBlock(T* b) { std::allocator<T>().deallocate(b, BlockElems); }
+
+    // The slot is reserved first, so a throwing allocation leaks nothing and
+    // the push_back after it cannot throw.
+    void addBlock() {
+        if (blocks_.size() == blocks_.capacity()) blocks_.reserve(std::max<std::size_t>(1, 2 * blocks_.size()));
+        blocks_.push_back(allocateBlock());
+    }
+
+    std::vector<T*> blocks_; // raw storage; only [0, size_) is constructed
+    std::size_t size_ = 0;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "Analyzer.h"
+#include "Sorter.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sort-and-split of one large file over several processes. The coordinator
+// cuts the input into line-aligned byte ranges (shards), runs one worker per
+// shard through the read -> sort -> split -> write pipeline, and merges the
+// workers' sorted passed and failed files. A worker is this executable run
+// as "shard-worker" with its Task on the command line: it reads only its
+// range and writes only its two files, so launching is the one step that
+// changes for shards run on other machines over a shared file system.
+namespace Shard {
+
+struct Task {
+    std::string input;
+    std::uint64_t begin = 0; // the records whose lines start in [begin, end)
+    std::uint64_t end = 0;
+    std::string outPass;
+    std::string outFail;
+    Sorter::SortOrder order = Sorter::SortOrder::Grade;
+};
+
+// One Task per shard, in input order, writing shard-<i>.{passed,failed}.txt
+// under workDir. Fewer than `shards` when the file has too few lines.
+// Throws FileException.
+std::vector<Task> plan(const std::string& input, unsigned shards, const std::string& workDir,
+                       Sorter::SortOrder order);
+
+// The worker's command line after "shard-worker", and back. taskFromArgs
+// throws ParseException.
+std::vector<std::string> taskArgs(const Task& t);
+Task taskFromArgs(const std::vector<std::string>& args);
+
+// The worker side: a vector pipeline (Strategy 2) over the task's range in
+// the task's order, sorting on Analyzer::threads() threads.
+PerfResult runTask(const Task& t);
+
+// What a worker prints on stdout for its coordinator:
+// "<students> <read> <sort> <split> <write> <total>". Throws ParseException.
+std::string resultLine(const PerfResult& r);
+PerfResult resultFromLine(const std::string& line);
+
+struct Config {
+    unsigned workers = 0; // 0 = one per hardware thread; at most MAX_WORKERS
+    std::string workDir;  // parent of the shard files; empty = the system temp directory
+};
+
+struct Result {
+    std::vector<PerfResult> shards; // as each worker reported, in input order
+    std::uint64_t records = 0;
+    std::uint64_t passed = 0;
+    double planMs = 0.0;
+    double workMs = 0.0;  // first launch to last exit
+    double mergeMs = 0.0; // both outputs
+    double totalMs = 0.0;
+};
+
+// Plans, runs every worker at once as a child process and merges, in
+// Sorter::order(). The shard files are removed afterwards. Throws
+// FileException, naming the shard, when a worker fails.
+Result run(const std::string& input, const std::string& outPass, const std::string& outFail, const Config& cfg);
+
+// Every shard's output is one input of the final merge.
+inline constexpr unsigned MAX_WORKERS = 256;
+
+} // namespace Shard
+
+#endif
@@ -2,14 +2,199 @@
 #define SORTER_H
 
 #include "Student.h"
-#include <vector>
+#include "Trace.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <list>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Sorter {
-    void sortVectorDesc(std::vector<Student>& v);
-    void sortDequeDesc(std::deque<Student>& d);
-    void sortListDesc(std::list<Student>& l);
+
+struct ByGradeDesc {
+    bool operator()(const Student& a, const Student& b) const {
+        return a.finalAvgCached() > b.finalAvgCached();
+    }
+};
+
+// The total order: final grade descending, then surname, then name.
+struct ByGradeSurnameName {
+    bool operator()(const Student& a, const Student& b) const {
+        if (a.finalAvgCached() != b.finalAvgCached()) return a.finalAvgCached() > b.finalAvgCached();
+        if (int c = a.getSurname().compare(b.getSurname())) return c < 0;
+        return a.getName() < b.getName();
+    }
+};
+
+// Which order the pipelines sort into. Grade: by final grade only, equal
+// grades in unspecified order. Total: ByGradeSurnameName, remaining ties in
+// input order, so every container and thread count writes the same files.
+enum class SortOrder { Grade, Total };
+
+// SGC_ORDER (grade or total; default grade) unless setOrder says otherwise.
+SortOrder order();
+void setOrder(SortOrder o);
+SortOrder orderFromName(const std::string& name); // throws ParseException
+const char* orderName(SortOrder o);
+
+// Below this many records per slice the thread start-up outweighs the gain.
+inline constexpr std::size_t MIN_PARALLEL_SLICE = 1 << 14;
+
+// Sorts any random-access range by comp. threads > 1 sorts that many slices
+// concurrently, then merges them pairwise (also concurrently).
+template <typename It, typename Compare>
+void sortRange(It first, It last, Compare comp, unsigned threads = 1) {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t slices = std::min<std::size_t>(threads, n / MIN_PARALLEL_SLICE);
+    if (slices <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<It> bounds;
+    for (std::size_t k = 0; k <= slices; ++k) bounds.push_back(first + static_cast<std::ptrdiff_t>(n * k / slices));
+
+    std::vector<std::thread> pool;
+    for (std::size_t k = 1; k < slices; ++k) {
+        pool.emplace_back([&bounds, &comp, k] {
+            Trace::setThreadName("sort worker");
+            Trace::Span span("sort slice", "sort");
+            std::sort(bounds[k], bounds[k + 1], comp);
+        });
+    }
+    {
+        Trace::Span span("sort slice", "sort");
+        std::sort(bounds[0], bounds[1], comp);
+    }
+    for (auto& t : pool) t.join();
+
+    // Merge neighbouring runs until one is left; each round's merges are independent.
+    for (std::size_t width = 1; width < slices; width *= 2) {
+        pool.clear();
+        for (std::size_t k = 0; k + width < slices; k += 2 * width) {
+            It lo = bounds[k];
+            It mid = bounds[k + width];
+            It hi = bounds[std::min(k + 2 * width, slices)];
+            pool.emplace_back([lo, mid, hi, &comp] {
+                Trace::setThreadName("sort worker");
+                Trace::Span span("merge runs", "sort");
+                std::inplace_merge(lo, mid, hi, comp);
+            });
+        }
+        for (auto& t : pool) t.join();
+    }
 }
 
+// By final grade, descending; order among equal grades is unspecified.
+template <typename It>
+void sortRangeDesc(It first, It last, unsigned threads = 1) {
+    sortRange(first, last, ByGradeDesc(), threads);
+}
+
+// -------------------- TOTAL ORDER --------------------
+
+// A record's packed sort key and its position in the input.
+struct PackedKey {
+    std::uint64_t key;
+    std::size_t index;
+};
+
+// keys[i] = {packed key of *records[i], i}. The high bits hold the record's
+// rank among the distinct final grades (best first), as few bits as the
+// ranks need; the rest hold as many bytes of its surname as fit, starting
+// after the prefix every surname shares. Equal keys mean equal grades, and
+// key order never contradicts ByGradeSurnameName, so most comparisons are
+// one integer compare.
+std::vector<PackedKey> packKeys(const std::vector<const Student*>& records);
+
+// Key first; on equal keys surname, then name, then input position.
+struct ByPackedKey {
+    const std::vector<const Student*>* records;
+
+    bool operator()(const PackedKey& a, const PackedKey& b) const {
+        if (a.key != b.key) return a.key < b.key;
+        const Student& x = *(*records)[a.index];
+        const Student& y = *(*records)[b.index];
+        if (int c = x.getSurname().compare(y.getSurname())) return c < 0;
+        if (int c = x.getName().compare(y.getName())) return c < 0;
+        return a.index < b.index;
+    }
+};
+
+// Sorts the (key, index) array, then moves each record to its place along
+// the permutation's cycles: every record is moved once, not compared.
+template <typename It>
+void sortRangeTotal(It first, It last, unsigned threads = 1) {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    std::vector<const Student*> records;
+    records.reserve(n);
+    for (It it = first; it != last; ++it) records.push_back(&*it);
+    auto keys = packKeys(records);
+    sortRange(keys.begin(), keys.end(), ByPackedKey{&records}, threads);
+
+    auto at = [first](std::size_t i) -> Student& { return *(first + static_cast<std::ptrdiff_t>(i)); };
+    std::vector<bool> placed(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (placed[i]) continue;
+        placed[i] = true;
+        if (keys[i].index == i) continue;
+        Student held = std::move(at(i));
+        std::size_t j = i;
+        for (std::size_t k = keys[j].index; k != i; j = k, k = keys[j].index) {
+            at(j) = std::move(at(k));
+            placed[k] = true;
+        }
+        at(j) = std::move(held);
+    }
+}
+
+// The same for a list: the nodes are relinked in key order.
+template <typename A>
+void sortListTotal(std::list<Student, A>& l) {
+    using It = typename std::list<Student, A>::iterator;
+    std::vector<It> nodes;
+    std::vector<const Student*> records;
+    nodes.reserve(l.size());
+    records.reserve(l.size());
+    for (It it = l.begin(); it != l.end(); ++it) {
+        nodes.push_back(it);
+        records.push_back(&*it);
+    }
+    auto keys = packKeys(records);
+    std::sort(keys.begin(), keys.end(), ByPackedKey{&records});
+    for (const auto& k : keys) l.splice(l.end(), l, nodes[k.index]);
+}
+
+// List sort that leaves the nodes where they are: gathers (key, node) pairs
+// into an array, sorts the array and relinks the nodes in that order with
+// O(1) splices. The comparisons read the contiguous array instead of chasing
+// node pointers; stable, so equal grades keep their order as with list::sort.
+template <typename A>
+void sortListByKeyDesc(std::list<Student, A>& l) {
+    using It = typename std::list<Student, A>::iterator;
+    std::vector<std::pair<double, It>> keyed;
+    keyed.reserve(l.size());
+    for (It it = l.begin(); it != l.end(); ++it) keyed.emplace_back(it->finalAvgCached(), it);
+
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& k : keyed) l.splice(l.end(), l, k.second);
+}
+
+// The common instantiations are compiled once, in Sorter.cpp.
+extern template void sortRangeDesc(std::vector<Student>::iterator, std::vector<Student>::iterator, unsigned);
+extern template void sortRangeDesc(std::deque<Student>::iterator, std::deque<Student>::iterator, unsigned);
+extern template void sortRangeTotal(std::vector<Student>::iterator, std::vector<Student>::iterator, unsigned);
+extern template void sortRangeTotal(std::deque<Student>::iterator, std::deque<Student>::iterator, unsigned);
+
+void sortVectorDesc(std::vector<Student>& v, unsigned threads = 1);
+void sortDequeDesc(std::deque<Student>& d, unsigned threads = 1);
+void sortListDesc(std::list<Student>& l);
+
+} // namespace Sorter
+
 #endif
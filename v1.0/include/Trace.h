@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Scoped spans recorded into per-thread buffers and exported as Chrome
+// trace-event JSON (chrome://tracing, ui.perfetto.dev).
+//
+// The clock is the invariant TSC where the CPU advertises one, calibrated
+// against steady_clock, and steady_clock otherwise. Recording a span takes
+// no lock: each thread appends to its own chunked buffer.
+namespace Trace {
+
+// Off by default; SGC_TRACE=1 in the environment or setEnabled(true) turns it on.
+bool enabled();
+void setEnabled(bool on);
+
+// Raw clock ticks and their conversion; usable as a timer with tracing off.
+std::uint64_t now();
+double toMs(std::uint64_t ticks);
+
+// Names and categories must be string literals (or otherwise outlive the export).
+void record(const char* name, const char* category, std::uint64_t begin, std::uint64_t end);
+
+// Labels the calling thread's row in the trace.
+void setThreadName(const char* name);
+
+// Records [construction, stop() or destruction) when tracing is enabled.
+class Span {
+public:
+    explicit Span(const char* name, const char* category = "sgc")
+        : name_(name), category_(category), begin_(now()) {}
+    ~Span() {
+        if (!stopped_) stop();
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // Ends the span (first call only) and returns its length in milliseconds.
+    double stop() {
+        std::uint64_t end = now();
+        if (!stopped_) {
+            stopped_ = true;
+            end_ = end;
+            if (enabled()) record(name_, category_, begin_, end_);
+        }
+        return toMs(end_ - begin_);
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    std::uint64_t begin_;
+    std::uint64_t end_ = 0;
+    bool stopped_ = false;
+};
+
+// Drops every recorded span. Only call while no other thread is recording.
+void clear();
+std::size_t spanCount();
+
+void writeChromeJson(std::ostream& out);
+void writeChromeJson(const std::string& path); // throws FileException
+
+} // namespace Trace
+
+#endif
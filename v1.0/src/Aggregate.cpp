@@ -0,0 +1,183 @@
+#include "Aggregate.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+
+namespace fs = std::filesystem;
+
+namespace Aggregate {
+
+// -------------------- AGGREGATES --------------------
+
+static bool beats(const GradeStats::Grade& a, const GradeStats::Grade& b, bool high) {
+    return high ? b < a : a < b;
+}
+
+static void offer(Extreme& x, bool high, const GradeStats::Grade& g, const RecordScanner::Record& r, std::size_t file,
+                  std::uint64_t offset, std::size_t keep) {
+    if (x.ties == 0 || beats(g, x.grade, high)) {
+        x.grade = g;
+        x.ties = 0;
+        x.holders.clear();
+    } else if (!(g == x.grade)) {
+        return;
+    }
+    ++x.ties;
+    if (x.holders.size() < keep) x.holders.push_back({std::string(r.name), std::string(r.surname), file, offset});
+}
+
+static void mergeExtreme(Extreme& x, const Extreme& y, bool high, std::size_t keep) {
+    if (y.ties == 0) return;
+    if (x.ties == 0 || beats(y.grade, x.grade, high)) {
+        x = y;
+        return;
+    }
+    if (!(y.grade == x.grade)) return;
+    x.ties += y.ties;
+    x.holders.insert(x.holders.end(), y.holders.begin(), y.holders.end());
+    std::sort(x.holders.begin(), x.holders.end(), [](const Holder& a, const Holder& b) {
+        return a.file != b.file ? a.file < b.file : a.offset < b.offset;
+    });
+    if (x.holders.size() > keep) x.holders.resize(keep);
+}
+
+void Summary::add(const RecordScanner::Record& r, std::size_t file, std::uint64_t offset) {
+    const double avg = r.finalAvg();
+    ++records;
+    if (avg >= Pipeline::PASS_CUTOFF) ++passed;
+    finalAvgSum += avg;
+    const auto g = GradeStats::finalAvgGrade(r.homeworkSum(), r.homework.size(), r.exam);
+    offer(highest, true, g, r, file, offset, keep);
+    offer(lowest, false, g, r, file, offset, keep);
+}
+
+void Summary::merge(const Summary& other) {
+    records += other.records;
+    passed += other.passed;
+    finalAvgSum += other.finalAvgSum;
+    mergeExtreme(highest, other.highest, true, keep);
+    mergeExtreme(lowest, other.lowest, false, keep);
+}
+
+// -------------------- SCAN --------------------
+
+struct Chunk {
+    std::size_t file;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+Summary scanFiles(const std::vector<std::string>& files, unsigned threads, std::size_t keep,
+                  std::uint64_t chunkBytes) {
+    Trace::Span span("aggregate files", "aggregate");
+    keep = std::max<std::size_t>(keep, 1);
+    chunkBytes = std::max<std::uint64_t>(chunkBytes, 1);
+    std::vector<Chunk> chunks;
+    for (std::size_t f = 0; f < files.size(); ++f) {
+        std::error_code ec;
+        const auto size = static_cast<std::uint64_t>(fs::file_size(files[f], ec));
+        if (ec) throw FileException("Cannot open file: " + files[f]);
+        const auto parts = static_cast<unsigned>(std::max<std::uint64_t>(1, (size + chunkBytes - 1) / chunkBytes));
+        const auto bounds = RecordScanner::lineBounds(files[f], parts);
+        for (unsigned k = 0; k < parts; ++k)
+            if (bounds[k] < bounds[k + 1]) chunks.push_back({f, bounds[k], bounds[k + 1]});
+    }
+
+    // chunks are handed out in input order, so each worker sees its records
+    // in input order too
+    const unsigned workers = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(chunks.size())));
+    std::vector<Summary> partial(workers, Summary(keep));
+    std::atomic<std::size_t> next{0};
+    Pipeline::runParts(workers, "aggregate worker", [&](unsigned w) {
+        RecordScanner::Record r;
+        for (std::size_t c; (c = next.fetch_add(1)) < chunks.size();) {
+            Trace::Span span("aggregate chunk", "aggregate");
+            const Chunk& ch = chunks[c];
+            RecordScanner::forEachLineAt(files[ch.file], ch.begin, ch.end, [&](std::uint64_t at, std::string_view line) {
+                if (RecordScanner::parseLine(line, r)) partial[w].add(r, ch.file, at);
+            });
+        }
+    });
+    for (unsigned w = 1; w < workers; ++w) partial[0].merge(partial[w]);
+    return std::move(partial[0]);
+}
+
+// -------------------- REPORTING --------------------
+
+struct Side {
+    const char* name;
+    const char* label;
+    Extreme Summary::*extreme;
+};
+static const Side SIDES[] = {{"highest", "Highest", &Summary::highest}, {"lowest", "Lowest ", &Summary::lowest}};
+
+static void reportText(std::ostream& out, const std::vector<std::string>& files, const Summary& s) {
+    if (s.records == 0) {
+        out << "No student records found.\n";
+        return;
+    }
+    out << std::fixed << std::setprecision(2);
+    for (const auto& side : SIDES) {
+        const Extreme& x = s.*side.extreme;
+        const Holder& h = x.holders.front();
+        out << side.label << ": " << h.name << " " << h.surname << " (" << x.grade.value() << ")";
+        if (x.ties > 1) out << ", tied with " << x.ties - 1 << " more";
+        out << "\n";
+        for (std::size_t i = 1; i < x.holders.size(); ++i)
+            out << "         " << x.holders[i].name << " " << x.holders[i].surname << "\n";
+        if (x.ties > x.holders.size()) out << "         ...\n";
+    }
+    out << "Total: " << s.records << "  passed: " << s.passed << "  failed: " << s.records - s.passed
+        << "  mean: " << s.mean() << "  files: " << files.size() << "\n"
+        << std::defaultfloat;
+}
+
+static void reportJson(std::ostream& out, const std::vector<std::string>& files, const Summary& s) {
+    out << "{\n  \"files\": [";
+    for (std::size_t i = 0; i < files.size(); ++i)
+        out << (i ? ", " : "") << "\"" << Benchmark::jsonEscape(files[i]) << "\"";
+    out << "],\n  \"records\": " << s.records << ", \"passed\": " << s.passed << ", \"failed\": "
+        << s.records - s.passed << std::setprecision(10) << ", \"mean\": " << s.mean();
+    for (const auto& side : SIDES) {
+        const Extreme& x = s.*side.extreme;
+        out << ",\n  \"" << side.name << "\": {\"ties\": " << x.ties;
+        if (x.ties > 0)
+            out << ", \"num\": " << x.grade.num << ", \"den\": " << x.grade.den << ", \"finalAvg\": " << x.grade.value();
+        out << ", \"holders\": [";
+        for (std::size_t i = 0; i < x.holders.size(); ++i) {
+            const Holder& h = x.holders[i];
+            out << (i ? "," : "") << "\n    {\"name\": \"" << Benchmark::jsonEscape(h.name) << "\", \"surname\": \""
+                << Benchmark::jsonEscape(h.surname) << "\", \"file\": \"" << Benchmark::jsonEscape(files[h.file])
+                << "\", \"offset\": " << h.offset << "}";
+        }
+        out << "]}";
+    }
+    out << "\n}\n" << std::defaultfloat;
+}
+
+static void reportCsv(std::ostream& out, const std::vector<std::string>& files, const Summary& s) {
+    out << "extreme,name,surname,finalAvg,file,offset\n" << std::setprecision(10);
+    for (const auto& side : SIDES) {
+        const Extreme& x = s.*side.extreme;
+        for (const auto& h : x.holders)
+            out << side.name << "," << h.name << "," << h.surname << "," << x.grade.value() << "," << files[h.file]
+                << "," << h.offset << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+void report(std::ostream& out, const std::vector<std::string>& files, const Summary& s,
+            Benchmark::OutputFormat format) {
+    switch (format) {
+    case Benchmark::OutputFormat::Text: reportText(out, files, s); break;
+    case Benchmark::OutputFormat::Json: reportJson(out, files, s); break;
+    case Benchmark::OutputFormat::Csv: reportCsv(out, files, s); break;
+    }
+}
+
+} // namespace Aggregate
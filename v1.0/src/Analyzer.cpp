@@ -1,132 +1,80 @@
 #include "Analyzer.h"
-#include "ExceptionHandlers.h"
-#include "Sorter.h"
+#include "Pipeline.h"
 
 #include <algorithm>
-#include <chrono>
-#include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
-#include <iterator>
-#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
-using namespace std::chrono;
-
 namespace Analyzer {
 
-static constexpr double PASS_CUTOFF = 5.0;
+// -------------------- THREADS --------------------
 
-static inline double msBetween(const high_resolution_clock::time_point& a,
-                               const high_resolution_clock::time_point& b) {
-    return duration<double, std::milli>(b - a).count();
-}
+static std::atomic<unsigned> threadSetting{0}; // 0: not yet read from the environment
 
-static inline bool isPassed(const Student& s) {
-    return s.finalAvgCached() >= PASS_CUTOFF;
+static unsigned resolveThreads(unsigned n) {
+    if (n == 0) n = std::thread::hardware_concurrency();
+    return n ? n : 1;
 }
 
-template <typename It, typename Pred>
-static It doPartition(It first, It last, Pred pred, PartitionMode pmode) {
-    return (pmode == PartitionMode::StablePartition)
-        ? std::stable_partition(first, last, pred)
-        : std::partition(first, last, pred);
-}
-
-// -------------------- READERS --------------------
-
-static void ensureCache(std::vector<Student>& v) {
-    std::transform(v.begin(), v.end(), v.begin(), [](Student s) {
-        s.computeCache();
-        return s;
-    });
+unsigned threads() {
+    unsigned n = threadSetting.load(std::memory_order_relaxed);
+    if (n == 0) {
+        const char* env = std::getenv("SGC_THREADS");
+        n = 1;
+        if (env && *env) {
+            try { n = resolveThreads(static_cast<unsigned>(std::stoul(env))); } catch (...) {}
+        }
+        threadSetting.store(n, std::memory_order_relaxed);
+    }
+    return n;
 }
 
-static void ensureCache(std::deque<Student>& d) {
-    std::transform(d.begin(), d.end(), d.begin(), [](Student s) {
-        s.computeCache();
-        return s;
-    });
+void setThreads(unsigned n) {
+    threadSetting.store(resolveThreads(n), std::memory_order_relaxed);
 }
 
-static void ensureCache(std::list<Student>& l) {
-    std::list<Student> rebuilt;
-    std::transform(l.begin(), l.end(), std::back_inserter(rebuilt), [](Student s) {
-        s.computeCache();
-        return s;
-    });
-    l.swap(rebuilt);
-}
+// -------------------- READERS / WRITERS --------------------
+// The per-container entry points are instantiations of the Pipeline templates.
 
 std::vector<Student> readVectorFromFile(const std::string& filename) {
-    std::ifstream in(filename);
-    if (!in.is_open()) throw FileException("Cannot open file: " + filename);
-
-    std::vector<Student> out;
-    while (in.good()) {
-        Student s;
-        in >> s;
-        if (!in && in.eof()) break;
-        if (!s.isValidBasic()) continue;
-        out.push_back(std::move(s));
-    }
-
-    ensureCache(out);
-    return out;
+    return Pipeline::readFile<std::vector<Student>>(filename);
 }
 
 std::deque<Student> readDequeFromFile(const std::string& filename) {
-    std::ifstream in(filename);
-    if (!in.is_open()) throw FileException("Cannot open file: " + filename);
-
-    std::deque<Student> out;
-    while (in.good()) {
-        Student s;
-        in >> s;
-        if (!in && in.eof()) break;
-        if (!s.isValidBasic()) continue;
-        out.push_back(std::move(s));
-    }
-
-    ensureCache(out);
-    return out;
+    return Pipeline::readFile<std::deque<Student>>(filename);
 }
 
 std::list<Student> readListFromFile(const std::string& filename) {
-    std::ifstream in(filename);
-    if (!in.is_open()) throw FileException("Cannot open file: " + filename);
-
-    std::list<Student> out;
-    while (in.good()) {
-        Student s;
-        in >> s;
-        if (!in && in.eof()) break;
-        if (!s.isValidBasic()) continue;
-        out.push_back(std::move(s));
-    }
+    return Pipeline::readFile<std::list<Student>>(filename);
+}
+
+std::vector<Student> readVectorFromSource(FileGenerator::RecordSource& src) {
+    return Pipeline::readSource<std::vector<Student>>(src);
+}
 
-    ensureCache(out);
-    return out;
+std::deque<Student> readDequeFromSource(FileGenerator::RecordSource& src) {
+    return Pipeline::readSource<std::deque<Student>>(src);
 }
 
-// -------------------- WRITERS --------------------
+std::list<Student> readListFromSource(FileGenerator::RecordSource& src) {
+    return Pipeline::readSource<std::list<Student>>(src);
+}
 
 void writeToFile(const std::string& filename, const std::vector<Student>& students) {
-    std::ofstream out(filename);
-    if (!out.is_open()) throw FileException("Cannot open file for writing: " + filename);
-    for (const auto& s : students) out << s << "\n";
+    Pipeline::writeFile(filename, students);
 }
 
 void writeToFile(const std::string& filename, const std::deque<Student>& students) {
-    std::ofstream out(filename);
-    if (!out.is_open()) throw FileException("Cannot open file for writing: " + filename);
-    for (const auto& s : students) out << s << "\n";
+    Pipeline::writeFile(filename, students);
 }
 
 void writeToFile(const std::string& filename, const std::list<Student>& students) {
-    std::ofstream out(filename);
-    if (!out.is_open()) throw FileException("Cannot open file for writing: " + filename);
-    for (const auto& s : students) out << s << "\n";
+    Pipeline::writeFile(filename, students);
 }
 
 // -------------------- PERF PRINT --------------------
@@ -141,237 +89,128 @@ void printPerf(const std::string& tag, const PerfResult& r) {
         << " TOTAL=" << r.total_ms
         << " students=" << r.total_students
         << "\n";
-}
-
-// -------------------- STRATEGY 1 (COPY to two containers) --------------------
-// Requirement: original students container remains unchanged
 
-static void splitVector_Strategy1(const std::vector<Student>& students,
-                                  std::vector<Student>& passed,
-                                  std::vector<Student>& failed) {
-    passed.clear();
-    failed.clear();
-    passed.reserve(students.size() / 2);
-    failed.reserve(students.size() / 2);
-
-    // remove_copy_if required (used twice)
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(failed),
-                        [](const Student& s){ return isPassed(s); });
+    static const char* const stages[STAGE_COUNT] = {"read", "sort", "split", "write"};
+    for (std::size_t st = 0; st < STAGE_COUNT; ++st) {
+        const HwCounters& hw = r.hw[st];
+        if (!hw.any()) continue;
+
+        std::cout << "    " << std::left << std::setw(6) << stages[st] << std::right;
+        for (std::size_t c = 0; c < HwCounters::COUNT; ++c) {
+            std::cout << " " << HwCounters::name(c) << "=";
+            if (hw.present[c]) std::cout << hw.value[c];
+            else std::cout << "n/a";
+        }
+        if (hw.present[HwCounters::Cycles] && hw.present[HwCounters::Instructions] && hw.value[HwCounters::Cycles] > 0) {
+            std::cout << " ipc=" << std::fixed << std::setprecision(2)
+                      << static_cast<double>(hw.value[HwCounters::Instructions])
+                         / static_cast<double>(hw.value[HwCounters::Cycles])
+                      << std::defaultfloat;
+        }
+        if (hw.anyMultiplexed()) std::cout << " (multiplexed, scaled)";
+        std::cout << "\n";
+    }
 
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(passed),
-                        [](const Student& s){ return !isPassed(s); });
+    for (std::size_t st = 0; st < STAGE_COUNT; ++st) {
+        const MemStats& m = r.mem[st];
+        if (!m.valid) continue;
+        std::cout << "    " << std::left << std::setw(6) << stages[st] << std::right
+                  << " allocs=" << m.allocations
+                  << " alloc_bytes=" << m.bytesAllocated
+                  << " peak_live_bytes=" << m.peakLiveBytes
+                  << " peak_rss_kb=" << m.peakRssKb << "\n";
+    }
 }
 
-static void splitDeque_Strategy1(const std::deque<Student>& students,
-                                 std::deque<Student>& passed,
-                                 std::deque<Student>& failed) {
-    passed.clear();
-    failed.clear();
-
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(failed),
-                        [](const Student& s){ return isPassed(s); });
-
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(passed),
-                        [](const Student& s){ return !isPassed(s); });
+std::string strategyTag(SplitStrategy s) {
+    return (s == SplitStrategy::Strategy1_CopyToTwoContainers) ? "S1" : "S2";
 }
 
-static void splitList_Strategy1(const std::list<Student>& students,
-                                std::list<Student>& passed,
-                                std::list<Student>& failed) {
-    passed.clear();
-    failed.clear();
+std::string pmodeTag(PartitionMode p) {
+    return (p == PartitionMode::StablePartition) ? "stable" : "partition";
+}
 
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(failed),
-                        [](const Student& s){ return isPassed(s); });
+// -------------------- SPLIT STRATEGIES --------------------
+// Strategy 1 copies into two containers and leaves the input unchanged;
+// strategy 2 moves the failed students out and shrinks the base container.
 
-    std::remove_copy_if(students.begin(), students.end(),
-                        std::back_inserter(passed),
-                        [](const Student& s){ return !isPassed(s); });
+void splitVector_Strategy1(const std::vector<Student>& students,
+                           std::vector<Student>& passed, std::vector<Student>& failed) {
+    Pipeline::ContainerOps<std::vector<Student>>::splitCopy(students, passed, failed);
 }
 
-// -------------------- STRATEGY 2 (MOVE fails out, shrink base) --------------------
-// Requirement: only ONE new container created (failed). Base container becomes passed.
+void splitDeque_Strategy1(const std::deque<Student>& students,
+                          std::deque<Student>& passed, std::deque<Student>& failed) {
+    Pipeline::ContainerOps<std::deque<Student>>::splitCopy(students, passed, failed);
+}
 
-static void splitVector_Strategy2(std::vector<Student>& students,
-                                  std::vector<Student>& failed,
-                                  PartitionMode pmode) {
-    failed.clear();
-    failed.reserve(students.size() / 2);
+void splitList_Strategy1(const std::list<Student>& students,
+                         std::list<Student>& passed, std::list<Student>& failed) {
+    Pipeline::ContainerOps<std::list<Student>>::splitCopy(students, passed, failed);
+}
 
-    // partition required
-    auto it = doPartition(students.begin(), students.end(),
-                          [](const Student& s){ return isPassed(s); }, pmode);
+void splitVector_Strategy2(std::vector<Student>& students, std::vector<Student>& failed, PartitionMode pmode) {
+    Pipeline::ContainerOps<std::vector<Student>>::splitMove(students, failed, pmode);
+}
 
-    // copy required: move tail into failed
-    std::copy(std::make_move_iterator(it),
-              std::make_move_iterator(students.end()),
-              std::back_inserter(failed));
+void splitDeque_Strategy2(std::deque<Student>& students, std::deque<Student>& failed, PartitionMode pmode) {
+    Pipeline::ContainerOps<std::deque<Student>>::splitMove(students, failed, pmode);
+}
 
-    // erase tail (shrink base)
-    students.erase(it, students.end());
-    students.shrink_to_fit();
+void splitList_Strategy2(std::list<Student>& students, std::list<Student>& failed, PartitionMode pmode) {
+    Pipeline::ContainerOps<std::list<Student>>::splitMove(students, failed, pmode);
 }
 
-static void splitDeque_Strategy2(std::deque<Student>& students,
-                                 std::deque<Student>& failed,
-                                 PartitionMode pmode) {
-    failed.clear();
+// -------------------- PIPELINES --------------------
 
-    auto it = doPartition(students.begin(), students.end(),
-                          [](const Student& s){ return isPassed(s); }, pmode);
+PerfResult runVectorPipeline(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                             SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runFile<std::vector<Student>>(inputFile, outPass, outFail, strat, pmode, "vector pipeline");
+}
 
-    std::copy(std::make_move_iterator(it),
-              std::make_move_iterator(students.end()),
-              std::back_inserter(failed));
+PerfResult runDequePipeline(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                            SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runFile<std::deque<Student>>(inputFile, outPass, outFail, strat, pmode, "deque pipeline");
+}
 
-    students.erase(it, students.end());
+PerfResult runListPipeline(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                           SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runFile<std::list<Student>>(inputFile, outPass, outFail, strat, pmode, "list pipeline");
 }
 
-static void splitList_Strategy2(std::list<Student>& students,
-                                std::list<Student>& failed,
-                                PartitionMode pmode) {
-    failed.clear();
+PerfResult runSegmentedPipeline(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                                SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runFile<SegmentedStudents>(inputFile, outPass, outFail, strat, pmode, "segmented pipeline");
+}
 
-    // stable_partition (optional) OR partition required
-    auto it = doPartition(students.begin(), students.end(),
-                          [](const Student& s){ return isPassed(s); }, pmode);
+PerfResult runPooledListPipeline(const std::string& inputFile, const std::string& outPass, const std::string& outFail,
+                                 SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runFile<PooledStudents>(inputFile, outPass, outFail, strat, pmode, "pooled list pipeline");
+}
 
-    // for list, best move is splice (moves nodes, no copying)
-    failed.splice(failed.end(), students, it, students.end());
+PerfResult runVectorPipeline(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                             SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runSource<std::vector<Student>>(src, outPass, outFail, strat, pmode, "vector pipeline");
 }
 
-// -------------------- PIPELINES --------------------
+PerfResult runDequePipeline(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                            SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runSource<std::deque<Student>>(src, outPass, outFail, strat, pmode, "deque pipeline");
+}
 
-PerfResult runVectorPipeline(const std::string& inputFile,
-                             const std::string& outPass,
-                             const std::string& outFail,
-                             SplitStrategy strat,
-                             PartitionMode pmode) {
-    PerfResult r;
-    auto t0 = high_resolution_clock::now();
-
-    auto t_read_s = high_resolution_clock::now();
-    auto students = readVectorFromFile(inputFile);
-    auto t_read_e = high_resolution_clock::now();
-    r.read_ms = msBetween(t_read_s, t_read_e);
-    r.total_students = students.size();
-
-    auto t_sort_s = high_resolution_clock::now();
-    Sorter::sortVectorDesc(students);
-    auto t_sort_e = high_resolution_clock::now();
-    r.sort_ms = msBetween(t_sort_s, t_sort_e);
-
-    std::vector<Student> passed;
-    std::vector<Student> failed;
-
-    auto t_split_s = high_resolution_clock::now();
-    if (strat == SplitStrategy::Strategy1_CopyToTwoContainers) {
-        splitVector_Strategy1(students, passed, failed);
-    } else {
-        splitVector_Strategy2(students, failed, pmode);
-        // Base container is now passed students
-        passed = students; // convenience; you can also write students directly
-    }
-    auto t_split_e = high_resolution_clock::now();
-    r.split_ms = msBetween(t_split_s, t_split_e);
-
-    auto t_write_s = high_resolution_clock::now();
-    writeToFile(outPass, passed);
-    writeToFile(outFail, failed);
-    auto t_write_e = high_resolution_clock::now();
-    r.write_ms = msBetween(t_write_s, t_write_e);
-
-    r.total_ms = msBetween(t0, high_resolution_clock::now());
-    return r;
-}
-
-PerfResult runDequePipeline(const std::string& inputFile,
-                            const std::string& outPass,
-                            const std::string& outFail,
-                            SplitStrategy strat,
-                            PartitionMode pmode) {
-    PerfResult r;
-    auto t0 = high_resolution_clock::now();
-
-    auto t_read_s = high_resolution_clock::now();
-    auto students = readDequeFromFile(inputFile);
-    auto t_read_e = high_resolution_clock::now();
-    r.read_ms = msBetween(t_read_s, t_read_e);
-    r.total_students = students.size();
-
-    auto t_sort_s = high_resolution_clock::now();
-    Sorter::sortDequeDesc(students);
-    auto t_sort_e = high_resolution_clock::now();
-    r.sort_ms = msBetween(t_sort_s, t_sort_e);
-
-    std::deque<Student> passed;
-    std::deque<Student> failed;
-
-    auto t_split_s = high_resolution_clock::now();
-    if (strat == SplitStrategy::Strategy1_CopyToTwoContainers) {
-        splitDeque_Strategy1(students, passed, failed);
-    } else {
-        splitDeque_Strategy2(students, failed, pmode);
-        passed = students;
-    }
-    auto t_split_e = high_resolution_clock::now();
-    r.split_ms = msBetween(t_split_s, t_split_e);
-
-    auto t_write_s = high_resolution_clock::now();
-    writeToFile(outPass, passed);
-    writeToFile(outFail, failed);
-    auto t_write_e = high_resolution_clock::now();
-    r.write_ms = msBetween(t_write_s, t_write_e);
-
-    r.total_ms = msBetween(t0, high_resolution_clock::now());
-    return r;
-}
-
-PerfResult runListPipeline(const std::string& inputFile,
-                           const std::string& outPass,
-                           const std::string& outFail,
-                           SplitStrategy strat,
-                           PartitionMode pmode) {
-    PerfResult r;
-    auto t0 = high_resolution_clock::now();
-
-    auto t_read_s = high_resolution_clock::now();
-    auto students = readListFromFile(inputFile);
-    auto t_read_e = high_resolution_clock::now();
-    r.read_ms = msBetween(t_read_s, t_read_e);
-    r.total_students = students.size();
-
-    auto t_sort_s = high_resolution_clock::now();
-    Sorter::sortListDesc(students);
-    auto t_sort_e = high_resolution_clock::now();
-    r.sort_ms = msBetween(t_sort_s, t_sort_e);
-
-    std::list<Student> passed;
-    std::list<Student> failed;
-
-    auto t_split_s = high_resolution_clock::now();
-    if (strat == SplitStrategy::Strategy1_CopyToTwoContainers) {
-        splitList_Strategy1(students, passed, failed);
-    } else {
-        splitList_Strategy2(students, failed, pmode);
-        passed = students;
-    }
-    auto t_split_e = high_resolution_clock::now();
-    r.split_ms = msBetween(t_split_s, t_split_e);
+PerfResult runListPipeline(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                           SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runSource<std::list<Student>>(src, outPass, outFail, strat, pmode, "list pipeline");
+}
 
-    auto t_write_s = high_resolution_clock::now();
-    writeToFile(outPass, passed);
-    writeToFile(outFail, failed);
-    auto t_write_e = high_resolution_clock::now();
-    r.write_ms = msBetween(t_write_s, t_write_e);
+PerfResult runSegmentedPipeline(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                                SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runSource<SegmentedStudents>(src, outPass, outFail, strat, pmode, "segmented pipeline");
+}
 
-    r.total_ms = msBetween(t0, high_resolution_clock::now());
-    return r;
+PerfResult runPooledListPipeline(FileGenerator::RecordSource& src, const std::string& outPass, const std::string& outFail,
+                                 SplitStrategy strat, PartitionMode pmode) {
+    return Pipeline::runSource<PooledStudents>(src, outPass, outFail, strat, pmode, "pooled list pipeline");
 }
 
 // -------------------- REQUIRED ALGORITHM DEMOS: find/find_if/search --------------------
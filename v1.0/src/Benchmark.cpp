@@ -0,0 +1,708 @@
+#include "Benchmark.h"
+#include "ExceptionHandlers.h"
+#include "FileGenerator.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+namespace Benchmark {
+
+static const char* const GEN_PREFIX = "gen:";
+
+std::string containerName(ContainerKind c) {
+    switch (c) {
+    case ContainerKind::Vector: return "vector";
+    case ContainerKind::Deque: return "deque";
+    case ContainerKind::List: return "list";
+    case ContainerKind::Segmented: return "segmented";
+    case ContainerKind::PooledList: return "pooled-list";
+    }
+    return "?";
+}
+
+const std::vector<std::string>& stageNames() {
+    static const std::vector<std::string> names = {"read", "sort", "split", "write", "total"};
+    return names;
+}
+
+double stageValue(const PerfResult& r, std::size_t stage) {
+    switch (stage) {
+    case 0: return r.read_ms;
+    case 1: return r.sort_ms;
+    case 2: return r.split_ms;
+    case 3: return r.write_ms;
+    default: return r.total_ms;
+    }
+}
+
+std::vector<double> stageSamples(const BenchCase& c, std::size_t stage) {
+    std::vector<double> out;
+    out.reserve(c.samples.size());
+    for (const auto& r : c.samples) out.push_back(stageValue(r, stage));
+    return out;
+}
+
+HwCounters stageCounters(const BenchCase& c, std::size_t stage) {
+    HwCounters out;
+    if (c.samples.empty()) return out;
+
+    for (std::size_t k = 0; k < HwCounters::COUNT; ++k) {
+        std::vector<double> values;
+        bool present = true;
+        bool multiplexed = false;
+        for (const auto& r : c.samples) {
+            std::uint64_t v = 0;
+            for (std::size_t st = 0; st < STAGE_COUNT; ++st) {
+                if (stage < STAGE_COUNT && st != stage) continue;
+                present = present && r.hw[st].present[k];
+                multiplexed = multiplexed || r.hw[st].multiplexed[k];
+                v += r.hw[st].value[k];
+            }
+            values.push_back(static_cast<double>(v));
+        }
+        if (!present) continue;
+        out.present[k] = true;
+        out.multiplexed[k] = multiplexed;
+        out.value[k] = static_cast<std::uint64_t>(summarize(values).median);
+    }
+    return out;
+}
+
+MemStats stageMemory(const BenchCase& c, std::size_t stage) {
+    MemStats out;
+    std::vector<double> allocs, bytes, peakLive, peakRss;
+
+    for (const auto& r : c.samples) {
+        MemStats m;
+        for (std::size_t st = 0; st < STAGE_COUNT; ++st) {
+            if (stage < STAGE_COUNT && st != stage) continue;
+            const MemStats& s = r.mem[st];
+            if (!s.valid) return out;
+            m.allocations += s.allocations;
+            m.bytesAllocated += s.bytesAllocated;
+            m.peakLiveBytes = std::max(m.peakLiveBytes, s.peakLiveBytes);
+            m.peakRssKb = std::max(m.peakRssKb, s.peakRssKb);
+        }
+        allocs.push_back(static_cast<double>(m.allocations));
+        bytes.push_back(static_cast<double>(m.bytesAllocated));
+        peakLive.push_back(static_cast<double>(m.peakLiveBytes));
+        peakRss.push_back(static_cast<double>(m.peakRssKb));
+    }
+    if (allocs.empty()) return out;
+
+    out.valid = true;
+    out.allocations = static_cast<std::uint64_t>(summarize(allocs).median);
+    out.bytesAllocated = static_cast<std::uint64_t>(summarize(bytes).median);
+    out.peakLiveBytes = static_cast<std::uint64_t>(summarize(peakLive).median);
+    out.peakRssKb = static_cast<std::uint64_t>(summarize(peakRss).median);
+    return out;
+}
+
+SampleStats summarize(std::vector<double> samples) {
+    SampleStats st;
+    if (samples.empty()) return st;
+
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+
+    st.min = samples.front();
+    st.median = (n % 2 == 0) ? (samples[n/2 - 1] + samples[n/2]) / 2.0 : samples[n/2];
+    st.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(n);
+
+    // nearest-rank percentile
+    std::size_t rank = static_cast<std::size_t>(std::ceil(0.95 * static_cast<double>(n)));
+    st.p95 = samples[std::max<std::size_t>(rank, 1) - 1];
+
+    if (n > 1) {
+        double sq = 0.0;
+        for (double x : samples) sq += (x - st.mean) * (x - st.mean);
+        st.stddev = std::sqrt(sq / static_cast<double>(n - 1));
+    }
+    return st;
+}
+
+// -------------------- RUNNING --------------------
+
+static bool isSynthetic(const std::string& input) {
+    return input.rfind(GEN_PREFIX, 0) == 0;
+}
+
+// "gen:<count>[:<profile>]"
+static FileGenerator::RecordSource makeSource(const std::string& input, unsigned threads) {
+    std::string spec = input.substr(std::string(GEN_PREFIX).size());
+    FileGenerator::GeneratorOptions opts;
+    opts.threads = threads;
+
+    auto colon = spec.find(':');
+    if (colon != std::string::npos) {
+        opts.profile = FileGenerator::profileFromName(spec.substr(colon + 1));
+        spec = spec.substr(0, colon);
+    }
+
+    std::uint64_t count = 0;
+    try { count = std::stoull(spec); } catch (...) { throw ParseException("Bad synthetic input: " + input); }
+    return FileGenerator::RecordSource(count, opts);
+}
+
+// genThreads: generator threads for gen: inputs (0 = generator default)
+static PerfResult runOnce(BenchCase& c, bool writeOutputs, unsigned genThreads) {
+    std::string outPass, outFail;
+    if (writeOutputs) {
+        std::string base = c.input;
+        if (isSynthetic(c.input)) {
+            std::filesystem::create_directories("data/generated");
+            base = "data/generated/bench";
+        }
+        std::string tag = ".bench." + containerName(c.container) + "." + Analyzer::strategyTag(c.strategy)
+                        + "." + Analyzer::pmodeTag(c.pmode);
+        if (genThreads) tag += ".t" + std::to_string(c.threads);
+        outPass = base + tag + ".passed.txt";
+        outFail = base + tag + ".failed.txt";
+    }
+
+    if (isSynthetic(c.input)) {
+        auto src = makeSource(c.input, genThreads);
+        switch (c.container) {
+        case ContainerKind::Vector: return Analyzer::runVectorPipeline(src, outPass, outFail, c.strategy, c.pmode);
+        case ContainerKind::Deque: return Analyzer::runDequePipeline(src, outPass, outFail, c.strategy, c.pmode);
+        case ContainerKind::List: return Analyzer::runListPipeline(src, outPass, outFail, c.strategy, c.pmode);
+        case ContainerKind::Segmented: return Analyzer::runSegmentedPipeline(src, outPass, outFail, c.strategy, c.pmode);
+        case ContainerKind::PooledList: return Analyzer::runPooledListPipeline(src, outPass, outFail, c.strategy, c.pmode);
+        }
+    }
+
+    CacheControl::prepare(c.input, c.cacheMode);
+    c.residentBefore = CacheControl::residentFraction(c.input);
+
+    switch (c.container) {
+    case ContainerKind::Vector: return Analyzer::runVectorPipeline(c.input, outPass, outFail, c.strategy, c.pmode);
+    case ContainerKind::Deque: return Analyzer::runDequePipeline(c.input, outPass, outFail, c.strategy, c.pmode);
+    case ContainerKind::List: return Analyzer::runListPipeline(c.input, outPass, outFail, c.strategy, c.pmode);
+    case ContainerKind::Segmented: return Analyzer::runSegmentedPipeline(c.input, outPass, outFail, c.strategy, c.pmode);
+    case ContainerKind::PooledList: return Analyzer::runPooledListPipeline(c.input, outPass, outFail, c.strategy, c.pmode);
+    }
+    return PerfResult{};
+}
+
+std::vector<BenchCase> run(const BenchConfig& cfg) {
+    std::vector<BenchCase> cases;
+
+    if (cfg.hwCounters) {
+        PerfCounters::setEnabled(true);
+        if (!PerfCounters::CounterGroup().available())
+            std::cerr << "bench: hardware counters unavailable (check perf_event_paranoid); timing only\n";
+    }
+    if (cfg.memory) {
+        MemoryTracker::setEnabled(true);
+        if (!MemoryTracker::hooksInstalled())
+            std::cerr << "bench: built without SGC_ALLOC_TRACKING; only peak RSS is recorded\n";
+    }
+
+    if (!cfg.tracePath.empty()) Trace::setEnabled(true);
+
+    const Sorter::SortOrder previousOrder = Sorter::order();
+    Sorter::setOrder(cfg.order);
+
+    // 0 = leave Analyzer::threads() alone
+    const unsigned previousThreads = Analyzer::threads();
+    const std::vector<unsigned> threadCounts = cfg.threadCounts.empty() ? std::vector<unsigned>{0} : cfg.threadCounts;
+
+    for (const auto& input : cfg.inputs) {
+        for (auto container : cfg.containers) {
+            for (auto strat : cfg.strategies) {
+                for (auto pmode : cfg.pmodes) {
+                    // Strategy 1 never partitions, so one case covers every mode
+                    if (strat == SplitStrategy::Strategy1_CopyToTwoContainers && pmode != cfg.pmodes.front())
+                        continue;
+
+                    for (auto cache : cfg.cacheModes) {
+                        // In-memory sources never touch the page cache
+                        if (isSynthetic(input) && cache != cfg.cacheModes.front())
+                            continue;
+
+                        for (unsigned t : threadCounts) {
+                            if (t) Analyzer::setThreads(t);
+
+                            BenchCase c;
+                            c.input = input;
+                            c.container = container;
+                            c.strategy = strat;
+                            c.pmode = pmode;
+                            c.cacheMode = isSynthetic(input) ? CacheControl::CacheMode::AsIs : cache;
+                            c.threads = Analyzer::threads();
+
+                            std::cerr << "bench: " << input << " " << containerName(container) << " "
+                                      << Analyzer::strategyTag(strat) << " " << Analyzer::pmodeTag(pmode) << " "
+                                      << CacheControl::cacheModeName(c.cacheMode) << " threads=" << c.threads << "\n";
+
+                            const unsigned genThreads = t ? c.threads : 0;
+                            for (int i = 0; i < cfg.warmup; ++i) runOnce(c, cfg.writeOutputs, genThreads);
+                            for (int i = 0; i < cfg.repetitions; ++i)
+                                c.samples.push_back(runOnce(c, cfg.writeOutputs, genThreads));
+
+                            cases.push_back(std::move(c));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    Analyzer::setThreads(previousThreads);
+    Sorter::setOrder(previousOrder);
+    return cases;
+}
+
+// -------------------- REPORTING --------------------
+
+OutputFormat parseReportFormat(const std::string& name) {
+    if (name == "text") return OutputFormat::Text;
+    if (name == "json") return OutputFormat::Json;
+    if (name == "csv") return OutputFormat::Csv;
+    throw ParseException("Unknown format: " + name);
+}
+
+std::string jsonEscape(const std::string& s) {
+    static const char HEX[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(s.size());
+    for (char ch : s) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else if (ch == '\t') {
+            out += "\\t";
+        } else if (ch == '\r') {
+            out += "\\r";
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += HEX[c >> 4];
+            out += HEX[c & 0xf];
+        } else {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+static std::size_t studentsOf(const BenchCase& c) {
+    return c.samples.empty() ? 0 : c.samples.front().total_students;
+}
+
+static void reportText(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << std::fixed << std::setprecision(3);
+    for (const auto& c : cases) {
+        out << "\n" << c.input << "  " << containerName(c.container) << " "
+            << Analyzer::strategyTag(c.strategy) << " " << Analyzer::pmodeTag(c.pmode)
+            << " " << CacheControl::cacheModeName(c.cacheMode)
+            << "  (threads=" << c.threads << ", reps=" << c.samples.size() << ", students=" << studentsOf(c);
+        if (c.residentBefore >= 0.0) out << ", resident=" << c.residentBefore * 100.0 << "%";
+        out << ")\n";
+        out << std::left << std::setw(8) << "stage" << std::right
+            << std::setw(12) << "median" << std::setw(12) << "mean" << std::setw(12) << "stddev"
+            << std::setw(12) << "p95" << std::setw(12) << "min" << "\n";
+
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            SampleStats s = summarize(stageSamples(c, st));
+            out << std::left << std::setw(8) << stageNames()[st] << std::right
+                << std::setw(12) << s.median << std::setw(12) << s.mean << std::setw(12) << s.stddev
+                << std::setw(12) << s.p95 << std::setw(12) << s.min << "\n";
+        }
+
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            HwCounters hw = stageCounters(c, st);
+            if (!hw.any()) continue;
+            out << "  hw " << std::left << std::setw(6) << stageNames()[st] << std::right;
+            for (std::size_t k = 0; k < HwCounters::COUNT; ++k) {
+                out << " " << HwCounters::name(k) << "=";
+                if (hw.present[k]) out << hw.value[k];
+                else out << "n/a";
+            }
+            if (hw.anyMultiplexed()) out << " (multiplexed, scaled)";
+            out << "\n";
+        }
+
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            MemStats m = stageMemory(c, st);
+            if (!m.valid) continue;
+            out << "  mem " << std::left << std::setw(6) << stageNames()[st] << std::right
+                << " allocs=" << m.allocations << " alloc_bytes=" << m.bytesAllocated
+                << " peak_live_bytes=" << m.peakLiveBytes << " peak_rss_kb=" << m.peakRssKb << "\n";
+        }
+    }
+}
+
+static void reportCsv(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << "input,container,strategy,pmode,cache,threads,students,reps,stage,median_ms,mean_ms,stddev_ms,p95_ms,min_ms";
+    for (std::size_t k = 0; k < HwCounters::COUNT; ++k) out << "," << HwCounters::name(k);
+    out << ",multiplexed,allocs,alloc_bytes,peak_live_bytes,peak_rss_kb\n";
+    out << std::setprecision(6);
+    for (const auto& c : cases) {
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            SampleStats s = summarize(stageSamples(c, st));
+            out << c.input << "," << containerName(c.container) << ","
+                << Analyzer::strategyTag(c.strategy) << "," << Analyzer::pmodeTag(c.pmode) << ","
+                << CacheControl::cacheModeName(c.cacheMode) << "," << c.threads << ","
+                << studentsOf(c) << "," << c.samples.size() << "," << stageNames()[st] << ","
+                << s.median << "," << s.mean << "," << s.stddev << "," << s.p95 << "," << s.min;
+
+            // median counter values; empty when the counter was unavailable
+            HwCounters hw = stageCounters(c, st);
+            for (std::size_t k = 0; k < HwCounters::COUNT; ++k) {
+                out << ",";
+                if (hw.present[k]) out << hw.value[k];
+            }
+            out << "," << (hw.anyMultiplexed() ? 1 : 0);
+
+            MemStats m = stageMemory(c, st);
+            if (m.valid) {
+                out << "," << m.allocations << "," << m.bytesAllocated
+                    << "," << m.peakLiveBytes << "," << m.peakRssKb;
+            } else {
+                out << ",,,,";
+            }
+            out << "\n";
+        }
+    }
+}
+
+static void reportJson(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << std::setprecision(6);
+    out << "{\n  \"cases\": [";
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        out << (i ? "," : "") << "\n    {\"input\": \"" << jsonEscape(c.input) << "\""
+            << ", \"container\": \"" << containerName(c.container) << "\""
+            << ", \"strategy\": \"" << Analyzer::strategyTag(c.strategy) << "\""
+            << ", \"pmode\": \"" << Analyzer::pmodeTag(c.pmode) << "\""
+            << ", \"cache\": \"" << CacheControl::cacheModeName(c.cacheMode) << "\""
+            << ", \"threads\": " << c.threads
+            << (c.residentBefore >= 0.0 ? ", \"resident\": " + std::to_string(c.residentBefore) : std::string())
+            << ", \"students\": " << studentsOf(c)
+            << ", \"reps\": " << c.samples.size()
+            << ", \"stages\": {";
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            SampleStats s = summarize(stageSamples(c, st));
+            out << (st ? ", " : "") << "\"" << stageNames()[st] << "\": {"
+                << "\"median_ms\": " << s.median << ", \"mean_ms\": " << s.mean
+                << ", \"stddev_ms\": " << s.stddev << ", \"p95_ms\": " << s.p95
+                << ", \"min_ms\": " << s.min;
+
+            HwCounters hw = stageCounters(c, st);
+            if (hw.any()) {
+                out << ", \"hw\": {";
+                bool first = true;
+                for (std::size_t k = 0; k < HwCounters::COUNT; ++k) {
+                    if (!hw.present[k]) continue;
+                    out << (first ? "" : ", ") << "\"" << HwCounters::name(k) << "\": " << hw.value[k];
+                    first = false;
+                }
+                out << ", \"multiplexed\": " << (hw.anyMultiplexed() ? "true" : "false") << "}";
+            }
+
+            MemStats m = stageMemory(c, st);
+            if (m.valid) {
+                out << ", \"mem\": {\"allocs\": " << m.allocations
+                    << ", \"alloc_bytes\": " << m.bytesAllocated
+                    << ", \"peak_live_bytes\": " << m.peakLiveBytes
+                    << ", \"peak_rss_kb\": " << m.peakRssKb << "}";
+            }
+            out << "}";
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void report(std::ostream& out, const std::vector<BenchCase>& cases, OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Text: reportText(out, cases); break;
+    case OutputFormat::Json: reportJson(out, cases); break;
+    case OutputFormat::Csv: reportCsv(out, cases); break;
+    }
+}
+
+// -------------------- THREAD SCALING --------------------
+
+std::vector<unsigned> sweepThreadCounts(unsigned maxThreads) {
+    if (maxThreads == 0) maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+ScalingPoint scaling(const BenchCase& base, const BenchCase& c, std::size_t stage) {
+    ScalingPoint p;
+    p.medianMs = summarize(stageSamples(c, stage)).median;
+    const double baseMs = summarize(stageSamples(base, stage)).median;
+    // below a microsecond the stage did not run (e.g. write with --no-write)
+    if (p.medianMs >= 1e-3 && baseMs >= 1e-3) {
+        p.speedup = baseMs / p.medianMs;
+        p.efficiency = p.speedup * static_cast<double>(base.threads) / static_cast<double>(c.threads);
+        p.recordsPerSec = static_cast<double>(studentsOf(c)) / (p.medianMs / 1000.0);
+    }
+    return p;
+}
+
+static bool sameConfig(const BenchCase& a, const BenchCase& b) {
+    return a.input == b.input && a.container == b.container && a.strategy == b.strategy
+        && a.pmode == b.pmode && a.cacheMode == b.cacheMode;
+}
+
+// Baseline for each case: the lowest thread count with the same configuration.
+static const BenchCase& baselineOf(const std::vector<BenchCase>& cases, const BenchCase& c) {
+    const BenchCase* base = &c;
+    for (const auto& other : cases) {
+        if (sameConfig(other, c) && other.threads < base->threads) base = &other;
+    }
+    return *base;
+}
+
+static void reportScalingText(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << std::fixed;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const auto& base = baselineOf(cases, c);
+        if (i == 0 || !sameConfig(cases[i - 1], c)) {
+            out << "\n" << c.input << "  " << containerName(c.container) << " "
+                << Analyzer::strategyTag(c.strategy) << " " << Analyzer::pmodeTag(c.pmode)
+                << " " << CacheControl::cacheModeName(c.cacheMode)
+                << "  (students=" << studentsOf(c) << ", baseline " << base.threads << " thread"
+                << (base.threads == 1 ? "" : "s") << ")\n";
+            out << std::right << std::setw(7) << "threads" << "  " << std::left << std::setw(6) << "stage"
+                << std::right << std::setw(12) << "median_ms" << std::setw(10) << "speedup"
+                << std::setw(12) << "efficiency" << std::setw(14) << "records/s" << "\n";
+        }
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            ScalingPoint p = scaling(base, c, st);
+            out << std::right << std::setw(7) << c.threads << "  " << std::left << std::setw(6) << stageNames()[st]
+                << std::right << std::setprecision(3) << std::setw(12) << p.medianMs;
+            if (p.speedup > 0.0) {
+                out << std::setprecision(2) << std::setw(10) << p.speedup << std::setw(12) << p.efficiency
+                    << std::setprecision(0) << std::setw(14) << p.recordsPerSec << "\n";
+            } else {
+                out << std::setw(10) << "-" << std::setw(12) << "-" << std::setw(14) << "-" << "\n";
+            }
+        }
+    }
+}
+
+static void reportScalingCsv(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << "input,container,strategy,pmode,cache,threads,students,stage,median_ms,speedup,efficiency,records_per_s\n";
+    out << std::setprecision(6);
+    for (const auto& c : cases) {
+        const auto& base = baselineOf(cases, c);
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            ScalingPoint p = scaling(base, c, st);
+            out << c.input << "," << containerName(c.container) << ","
+                << Analyzer::strategyTag(c.strategy) << "," << Analyzer::pmodeTag(c.pmode) << ","
+                << CacheControl::cacheModeName(c.cacheMode) << "," << c.threads << ","
+                << studentsOf(c) << "," << stageNames()[st] << ","
+                << p.medianMs << ",";
+            if (p.speedup > 0.0) out << p.speedup << "," << p.efficiency << "," << p.recordsPerSec;
+            else out << ",,";
+            out << "\n";
+        }
+    }
+}
+
+static void reportScalingJson(std::ostream& out, const std::vector<BenchCase>& cases) {
+    out << std::setprecision(6);
+    out << "{\n  \"scaling\": [";
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const auto& base = baselineOf(cases, c);
+        out << (i ? "," : "") << "\n    {\"input\": \"" << jsonEscape(c.input) << "\""
+            << ", \"container\": \"" << containerName(c.container) << "\""
+            << ", \"strategy\": \"" << Analyzer::strategyTag(c.strategy) << "\""
+            << ", \"pmode\": \"" << Analyzer::pmodeTag(c.pmode) << "\""
+            << ", \"cache\": \"" << CacheControl::cacheModeName(c.cacheMode) << "\""
+            << ", \"threads\": " << c.threads
+            << ", \"baseline_threads\": " << base.threads
+            << ", \"students\": " << studentsOf(c)
+            << ", \"stages\": {";
+        for (std::size_t st = 0; st < stageNames().size(); ++st) {
+            ScalingPoint p = scaling(base, c, st);
+            out << (st ? ", " : "") << "\"" << stageNames()[st] << "\": {"
+                << "\"median_ms\": " << p.medianMs << ", \"speedup\": " << p.speedup
+                << ", \"efficiency\": " << p.efficiency << ", \"records_per_s\": " << p.recordsPerSec << "}";
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void reportScaling(std::ostream& out, const std::vector<BenchCase>& cases, OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Text: reportScalingText(out, cases); break;
+    case OutputFormat::Json: reportScalingJson(out, cases); break;
+    case OutputFormat::Csv: reportScalingCsv(out, cases); break;
+    }
+}
+
+// -------------------- ARGUMENTS --------------------
+
+std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream ss(s);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (!token.empty()) out.push_back(token);
+    }
+    return out;
+}
+
+int parseCount(const std::string& flag, const std::string& value) {
+    try {
+        int n = std::stoi(value);
+        if (n >= 0) return n;
+    } catch (...) {}
+    throw ParseException("Bad value for " + flag + ": " + value);
+}
+
+std::string usage() {
+    return "usage: student-grade-calculator bench [options] <input>...\n"
+           "  <input>                 file path, or gen:<count>[:<profile>] for in-memory records\n"
+           "  --containers LIST       vector,deque,list,segmented,pooled-list\n"
+           "                          (default: all)\n"
+           "  --strategies LIST       S1,S2 (default: both)\n"
+           "  --pmodes LIST           partition,stable (default: partition)\n"
+           "  --cache LIST            asis,cold,warm: evict or pre-read file inputs before each run\n"
+           "                          (default: asis)\n"
+           "  --warmup N              untimed runs per case (default: 1)\n"
+           "  --reps N                timed runs per case (default: 5)\n"
+           "  --format FMT            text|json|csv (default: text)\n"
+           "  --out FILE              write the report to FILE instead of stdout\n"
+           "  --no-write              skip writing passed/failed files\n"
+           "  --order ORDER           grade: by final grade only; total: grade, then surname,\n"
+           "                          then name (default: SGC_ORDER or grade)\n"
+           "  --hw-counters           record perf_event_open counters per stage (if permitted)\n"
+           "  --mem                   record allocations, peak heap and peak RSS per stage\n"
+           "  --trace FILE            write a Chrome trace (chrome://tracing, Perfetto) of all runs\n"
+           "  --threads LIST          pipeline thread counts, e.g. 1,2,4 (0 = all cores;\n"
+           "                          default: SGC_THREADS or 1)\n"
+           "  --max-threads N         same as --threads 1,2,4,...,N (0 = all cores)\n";
+}
+
+std::string sweepUsage() {
+    return "usage: student-grade-calculator sweep [options] [<input>...]\n"
+           "  Runs each case at 1, 2, 4, ... N pipeline threads and reports per-stage\n"
+           "  speedup, parallel efficiency and records/s against the 1-thread run.\n"
+           "  Inputs default to the students_<N>.txt files in data/generated;\n"
+           "  containers default to vector, strategies to S2, threads to all cores.\n"
+           "  Takes every bench option (--format csv for a CSV table).\n";
+}
+
+static void parseOptions(BenchConfig& cfg, const std::vector<std::string>& args) {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) throw ParseException("Missing value for " + a);
+            return args[++i];
+        };
+
+        if (a == "--containers") {
+            cfg.containers.clear();
+            for (const auto& t : splitList(value())) {
+                if (t == "vector") cfg.containers.push_back(ContainerKind::Vector);
+                else if (t == "deque") cfg.containers.push_back(ContainerKind::Deque);
+                else if (t == "list") cfg.containers.push_back(ContainerKind::List);
+                else if (t == "segmented") cfg.containers.push_back(ContainerKind::Segmented);
+                else if (t == "pooled-list") cfg.containers.push_back(ContainerKind::PooledList);
+                else throw ParseException("Unknown container: " + t);
+            }
+        } else if (a == "--strategies") {
+            cfg.strategies.clear();
+            for (const auto& t : splitList(value())) {
+                if (t == "S1" || t == "s1" || t == "1") cfg.strategies.push_back(SplitStrategy::Strategy1_CopyToTwoContainers);
+                else if (t == "S2" || t == "s2" || t == "2") cfg.strategies.push_back(SplitStrategy::Strategy2_MoveFailAndShrinkBase);
+                else throw ParseException("Unknown strategy: " + t);
+            }
+        } else if (a == "--pmodes") {
+            cfg.pmodes.clear();
+            for (const auto& t : splitList(value())) {
+                if (t == "partition") cfg.pmodes.push_back(PartitionMode::Partition);
+                else if (t == "stable") cfg.pmodes.push_back(PartitionMode::StablePartition);
+                else throw ParseException("Unknown partition mode: " + t);
+            }
+        } else if (a == "--cache") {
+            cfg.cacheModes.clear();
+            for (const auto& t : splitList(value())) cfg.cacheModes.push_back(CacheControl::cacheModeFromName(t));
+        } else if (a == "--warmup") {
+            cfg.warmup = parseCount(a, value());
+        } else if (a == "--reps") {
+            cfg.repetitions = parseCount(a, value());
+        } else if (a == "--format") {
+            cfg.format = parseReportFormat(value());
+        } else if (a == "--out") {
+            cfg.outPath = value();
+        } else if (a == "--no-write") {
+            cfg.writeOutputs = false;
+        } else if (a == "--order") {
+            cfg.order = Sorter::orderFromName(value());
+        } else if (a == "--hw-counters") {
+            cfg.hwCounters = true;
+        } else if (a == "--mem") {
+            cfg.memory = true;
+        } else if (a == "--trace") {
+            cfg.tracePath = value();
+        } else if (a == "--threads") {
+            cfg.threadCounts.clear();
+            for (const auto& t : splitList(value())) {
+                int n = parseCount(a, t);
+                cfg.threadCounts.push_back(n ? static_cast<unsigned>(n) : std::max(1u, std::thread::hardware_concurrency()));
+            }
+        } else if (a == "--max-threads") {
+            cfg.threadCounts = sweepThreadCounts(static_cast<unsigned>(parseCount(a, value())));
+        } else if (!a.empty() && a[0] == '-' && a != "-") {
+            throw ParseException("Unknown option: " + a);
+        } else {
+            cfg.inputs.push_back(a);
+        }
+    }
+}
+
+static void validate(const BenchConfig& cfg) {
+    if (cfg.inputs.empty()) throw ParseException("No inputs given");
+    if (cfg.containers.empty() || cfg.strategies.empty() || cfg.pmodes.empty() || cfg.cacheModes.empty())
+        throw ParseException("Empty container/strategy/partition/cache list");
+    if (cfg.repetitions < 1) throw ParseException("--reps must be at least 1");
+}
+
+BenchConfig parseArgs(const std::vector<std::string>& args) {
+    BenchConfig cfg;
+    parseOptions(cfg, args);
+    validate(cfg);
+    return cfg;
+}
+
+BenchConfig parseSweepArgs(const std::vector<std::string>& args) {
+    BenchConfig cfg;
+    cfg.containers = {ContainerKind::Vector};
+    cfg.strategies = {SplitStrategy::Strategy2_MoveFailAndShrinkBase};
+    cfg.threadCounts = sweepThreadCounts(0);
+    parseOptions(cfg, args);
+
+    if (cfg.inputs.empty()) {
+        for (std::uint64_t n : {1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL}) {
+            std::string file = "data/generated/students_" + std::to_string(n) + ".txt";
+            if (std::filesystem::exists(file)) cfg.inputs.push_back(file);
+        }
+    }
+    validate(cfg);
+    if (cfg.threadCounts.empty()) throw ParseException("Empty thread list");
+    return cfg;
+}
+
+} // namespace Benchmark
@@ -0,0 +1,86 @@
+#include "CacheControl.h"
+#include "ExceptionHandlers.h"
+
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CacheControl {
+
+std::string cacheModeName(CacheMode m) {
+    switch (m) {
+    case CacheMode::AsIs: return "asis";
+    case CacheMode::Cold: return "cold";
+    case CacheMode::Warm: return "warm";
+    }
+    return "?";
+}
+
+CacheMode cacheModeFromName(const std::string& name) {
+    if (name == "asis") return CacheMode::AsIs;
+    if (name == "cold") return CacheMode::Cold;
+    if (name == "warm") return CacheMode::Warm;
+    throw ParseException("Unknown cache mode: " + name);
+}
+
+// Closes the descriptor on every exit path.
+class FileHandle {
+public:
+    explicit FileHandle(const std::string& path) : fd_(open(path.c_str(), O_RDONLY)) {
+        if (fd_ < 0) throw FileException("Cannot open file: " + path);
+    }
+    ~FileHandle() { close(fd_); }
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+void evict(const std::string& path) {
+    FileHandle f(path);
+    // DONTNEED only drops clean pages, so flush anything still dirty first
+    fdatasync(f.fd());
+    posix_fadvise(f.fd(), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+void prewarm(const std::string& path) {
+    FileHandle f(path);
+    posix_fadvise(f.fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    std::vector<char> buf(1 << 20);
+    while (read(f.fd(), buf.data(), buf.size()) > 0) {}
+}
+
+void prepare(const std::string& path, CacheMode mode) {
+    if (mode == CacheMode::Cold) evict(path);
+    else if (mode == CacheMode::Warm) prewarm(path);
+}
+
+double residentFraction(const std::string& path) {
+    FileHandle f(path);
+    struct stat st{};
+    if (fstat(f.fd(), &st) != 0) return -1.0;
+    if (st.st_size == 0) return 1.0;
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, f.fd(), 0);
+    if (map == MAP_FAILED) return -1.0;
+
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((size + page - 1) / page);
+    double frac = -1.0;
+    if (mincore(map, size, pages.data()) == 0) {
+        std::size_t resident = 0;
+        for (unsigned char p : pages) resident += (p & 1);
+        frac = static_cast<double>(resident) / static_cast<double>(pages.size());
+    }
+    munmap(map, size);
+    return frac;
+}
+
+} // namespace CacheControl
@@ -0,0 +1,368 @@
+#include "Compare.h"
+#include "ExceptionHandlers.h"
+#include "FileGenerator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Compare {
+
+static const char* const GEN_PREFIX = "gen:";
+
+// Driver exit status for "this version has no such container"
+static const int EXIT_UNSUPPORTED = 2;
+
+const std::vector<std::string>& knownVersions() {
+    static const std::vector<std::string> versions = {"v0.1", "v0.2", "v0.25", "v1.0"};
+    return versions;
+}
+
+std::string driverPath(const std::string& dir, const std::string& version) {
+    return (fs::path(dir) / ("sgc-compare-" + version)).string();
+}
+
+// -------------------- RUNNING --------------------
+
+static std::string selfDirectory() {
+    std::error_code ec;
+    fs::path exe = fs::read_symlink("/proc/self/exe", ec);
+    return ec ? std::string(".") : exe.parent_path().string();
+}
+
+// Runs exe with args, capturing its stdout; stderr passes through. Returns the exit status.
+static int runDriver(const std::string& exe, const std::vector<std::string>& args, std::string& out) {
+    int fds[2];
+    if (pipe(fds) != 0) throw FileException("pipe failed for " + exe);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw FileException("fork failed for " + exe);
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(exe.c_str()));
+        for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(exe.c_str(), argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    out.clear();
+    char buf[4096];
+    for (;;) {
+        ssize_t n = read(fds[0], buf, sizeof buf);
+        if (n > 0) out.append(buf, static_cast<std::size_t>(n));
+        else if (n == 0 || errno != EINTR) break;
+    }
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// "<students> <read> <sort> <split> <write> <total>"
+static PerfResult parseDriverLine(const std::string& text, const std::string& exe) {
+    std::istringstream in(text);
+    PerfResult r;
+    if (!(in >> r.total_students >> r.read_ms >> r.sort_ms >> r.split_ms >> r.write_ms >> r.total_ms))
+        throw ParseException("Unexpected output from " + exe + ": " + text);
+    return r;
+}
+
+static std::size_t countLines(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(in),
+                                               std::istreambuf_iterator<char>(), '\n'));
+}
+
+// Scratch directory for generated inputs and pipeline outputs; removed on exit.
+struct WorkDir {
+    fs::path path = fs::temp_directory_path() / ("sgc-compare-" + std::to_string(getpid()));
+    WorkDir() { fs::create_directories(path); }
+    ~WorkDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+// gen:<count>[:<profile>] is written once and shared by every version.
+static std::string materialize(const std::string& input, const WorkDir& work) {
+    if (input.rfind(GEN_PREFIX, 0) != 0) return input;
+
+    std::string spec = input.substr(std::string(GEN_PREFIX).size());
+    FileGenerator::GeneratorOptions opts;
+    auto colon = spec.find(':');
+    if (colon != std::string::npos) {
+        opts.profile = FileGenerator::profileFromName(spec.substr(colon + 1));
+        spec = spec.substr(0, colon);
+    }
+    std::uint64_t count = 0;
+    try { count = std::stoull(spec); } catch (...) { throw ParseException("Bad synthetic input: " + input); }
+
+    std::string path = (work.path / ("students_" + spec + "_" + FileGenerator::profileName(opts.profile) + ".txt")).string();
+    if (!fs::exists(path)) FileGenerator::generateFile(path, count, opts);
+    return path;
+}
+
+std::vector<CompareCase> run(const CompareConfig& cfg) {
+    const std::string dir = cfg.driverDir.empty() ? selfDirectory() : cfg.driverDir;
+    for (const auto& v : cfg.versions) {
+        if (!fs::exists(driverPath(dir, v)))
+            throw FileException("Missing driver " + driverPath(dir, v) + " (build with SGC_BUILD_COMPARE=ON)");
+    }
+
+    WorkDir work;
+    const std::string outPass = (work.path / "passed.txt").string();
+    const std::string outFail = (work.path / "failed.txt").string();
+
+    std::vector<CompareCase> cases;
+    for (const auto& input : cfg.inputs) {
+        const std::string file = materialize(input, work);
+        for (const auto& container : cfg.containers) {
+            for (const auto& version : cfg.versions) {
+                CompareCase c;
+                c.input = input;
+                c.container = container;
+                c.version = version;
+
+                const std::string exe = driverPath(dir, version);
+                std::cerr << "compare: " << input << " " << container << " " << version << "\n";
+                for (int i = 0; i < cfg.warmup + cfg.repetitions; ++i) {
+                    CacheControl::prepare(file, cfg.cacheMode);
+                    std::string text;
+                    int status = runDriver(exe, {container, file, outPass, outFail}, text);
+                    if (status == EXIT_UNSUPPORTED) {
+                        c.supported = false;
+                        break;
+                    }
+                    if (status != 0) {
+                        throw FileException(exe + " failed on " + file + " (" + container
+                                            + ", exit status " + std::to_string(status) + ")");
+                    }
+                    PerfResult r = parseDriverLine(text, exe);
+                    c.passed = countLines(outPass);
+                    if (i >= cfg.warmup) c.samples.push_back(r);
+                }
+                fs::remove(outPass);
+                fs::remove(outFail);
+                cases.push_back(std::move(c));
+            }
+        }
+    }
+    return cases;
+}
+
+// -------------------- REPORTING --------------------
+
+static const std::size_t TOTAL_STAGE = 4;
+
+static std::size_t studentsOf(const CompareCase& c) {
+    return c.samples.empty() ? 0 : c.samples.front().total_students;
+}
+
+static double medianOf(const CompareCase& c, std::size_t stage) {
+    std::vector<double> xs;
+    for (const auto& r : c.samples) xs.push_back(Benchmark::stageValue(r, stage));
+    return Benchmark::summarize(xs).median;
+}
+
+static bool sameWorkload(const CompareCase& a, const CompareCase& b) {
+    return a.input == b.input && a.container == b.container;
+}
+
+// First version (in run order) that has the container; nullptr if none does.
+static const CompareCase* baselineOf(const std::vector<CompareCase>& cases, const CompareCase& c) {
+    for (const auto& other : cases) {
+        if (sameWorkload(other, c) && other.supported) return &other;
+    }
+    return nullptr;
+}
+
+// Baseline time over this version's time; 0 when either stage did not run.
+static double speedup(const CompareCase* base, const CompareCase& c, std::size_t stage) {
+    if (!base || !c.supported) return 0.0;
+    double mine = medianOf(c, stage);
+    double theirs = medianOf(*base, stage);
+    return (mine >= 1e-3 && theirs >= 1e-3) ? theirs / mine : 0.0;
+}
+
+static void reportText(std::ostream& out, const std::vector<CompareCase>& cases) {
+    out << std::fixed;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const CompareCase* base = baselineOf(cases, c);
+        if (i == 0 || !sameWorkload(cases[i - 1], c)) {
+            out << "\n" << c.input << "  " << c.container << " S1  (students=" << (base ? studentsOf(*base) : 0)
+                << ", reps=" << (base ? base->samples.size() : 0) << ", baseline "
+                << (base ? base->version : std::string("-")) << ")\n";
+            out << std::left << std::setw(8) << "version" << std::right << std::setw(10) << "passed";
+            for (const auto& name : Benchmark::stageNames()) out << std::setw(11) << name;
+            out << std::setw(10) << "speedup" << "\n";
+        }
+
+        out << std::left << std::setw(8) << c.version << std::right;
+        if (!c.supported) {
+            out << std::setw(10) << "n/a" << "  (no " << c.container << " pipeline)\n";
+            continue;
+        }
+        out << std::setw(10) << c.passed << std::setprecision(3);
+        for (std::size_t st = 0; st < Benchmark::stageNames().size(); ++st) out << std::setw(11) << medianOf(c, st);
+        double s = speedup(base, c, TOTAL_STAGE);
+        if (s > 0.0) out << std::setprecision(2) << std::setw(9) << s << "x\n";
+        else out << std::setw(10) << "-" << "\n";
+
+        if (base && c.passed != base->passed) {
+            out << "  note: " << c.version << " passed " << c.passed << " records, "
+                << base->version << " passed " << base->passed << "\n";
+        }
+    }
+}
+
+static void reportCsv(std::ostream& out, const std::vector<CompareCase>& cases) {
+    out << "input,container,version,supported,students,passed,reps,stage,median_ms,mean_ms,stddev_ms,min_ms,speedup\n";
+    out << std::setprecision(6);
+    for (const auto& c : cases) {
+        const CompareCase* base = baselineOf(cases, c);
+        for (std::size_t st = 0; st < Benchmark::stageNames().size(); ++st) {
+            std::vector<double> xs;
+            for (const auto& r : c.samples) xs.push_back(Benchmark::stageValue(r, st));
+            Benchmark::SampleStats s = Benchmark::summarize(xs);
+            double up = speedup(base, c, st);
+
+            out << c.input << "," << c.container << "," << c.version << "," << (c.supported ? 1 : 0) << ","
+                << studentsOf(c) << "," << c.passed << "," << c.samples.size() << ","
+                << Benchmark::stageNames()[st] << ",";
+            if (c.supported) out << s.median << "," << s.mean << "," << s.stddev << "," << s.min << ",";
+            else out << ",,,,";
+            if (up > 0.0) out << up;
+            out << "\n";
+        }
+    }
+}
+
+static void reportJson(std::ostream& out, const std::vector<CompareCase>& cases) {
+    out << std::setprecision(6);
+    out << "{\n  \"comparison\": [";
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto& c = cases[i];
+        const CompareCase* base = baselineOf(cases, c);
+        out << (i ? "," : "") << "\n    {\"input\": \"" << Benchmark::jsonEscape(c.input) << "\""
+            << ", \"container\": \"" << c.container << "\""
+            << ", \"version\": \"" << c.version << "\""
+            << ", \"supported\": " << (c.supported ? "true" : "false")
+            << ", \"baseline\": \"" << (base ? base->version : std::string()) << "\""
+            << ", \"students\": " << studentsOf(c)
+            << ", \"passed\": " << c.passed
+            << ", \"reps\": " << c.samples.size()
+            << ", \"stages\": {";
+        for (std::size_t st = 0; c.supported && st < Benchmark::stageNames().size(); ++st) {
+            std::vector<double> xs;
+            for (const auto& r : c.samples) xs.push_back(Benchmark::stageValue(r, st));
+            Benchmark::SampleStats s = Benchmark::summarize(xs);
+            out << (st ? ", " : "") << "\"" << Benchmark::stageNames()[st] << "\": {"
+                << "\"median_ms\": " << s.median << ", \"mean_ms\": " << s.mean
+                << ", \"stddev_ms\": " << s.stddev << ", \"min_ms\": " << s.min
+                << ", \"speedup\": " << speedup(base, c, st) << "}";
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void report(std::ostream& out, const std::vector<CompareCase>& cases, Benchmark::OutputFormat format) {
+    switch (format) {
+    case Benchmark::OutputFormat::Text: reportText(out, cases); break;
+    case Benchmark::OutputFormat::Json: reportJson(out, cases); break;
+    case Benchmark::OutputFormat::Csv: reportCsv(out, cases); break;
+    }
+}
+
+// -------------------- ARGUMENTS --------------------
+
+static bool knownContainer(const std::string& name) {
+    for (auto k : Benchmark::BenchConfig{}.containers) {
+        if (Benchmark::containerName(k) == name) return true;
+    }
+    return false;
+}
+
+std::string usage() {
+    return "usage: student-grade-calculator compare [options] <input>...\n"
+           "  Runs the same Strategy 1 pipeline through each version's core and reports\n"
+           "  median stage times and the total-time speedup over the first version.\n"
+           "  <input>                 file path, or gen:<count>[:<profile>] (generated once)\n"
+           "  --versions LIST         v0.1,v0.2,v0.25,v1.0 (default: all)\n"
+           "  --containers LIST       vector,deque,list (default); v1.0 also runs\n"
+           "                          segmented,pooled-list. v0.1 has vector only\n"
+           "  --cache MODE            asis|cold|warm before every run (default: warm)\n"
+           "  --warmup N              untimed runs per case (default: 1)\n"
+           "  --reps N                timed runs per case (default: 3)\n"
+           "  --format FMT            text|json|csv (default: text)\n"
+           "  --out FILE              write the report to FILE instead of stdout\n"
+           "  --drivers DIR           where the sgc-compare-<version> drivers are\n"
+           "                          (default: next to this executable)\n";
+}
+
+CompareConfig parseArgs(const std::vector<std::string>& args) {
+    CompareConfig cfg;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) throw ParseException("Missing value for " + a);
+            return args[++i];
+        };
+
+        if (a == "--versions") {
+            cfg.versions = Benchmark::splitList(value());
+            for (const auto& v : cfg.versions) {
+                const auto& known = knownVersions();
+                if (std::find(known.begin(), known.end(), v) == known.end()) throw ParseException("Unknown version: " + v);
+            }
+        } else if (a == "--containers") {
+            cfg.containers = Benchmark::splitList(value());
+            for (const auto& t : cfg.containers) {
+                if (!knownContainer(t)) throw ParseException("Unknown container: " + t);
+            }
+        } else if (a == "--cache") {
+            cfg.cacheMode = CacheControl::cacheModeFromName(value());
+        } else if (a == "--warmup") {
+            cfg.warmup = Benchmark::parseCount(a, value());
+        } else if (a == "--reps") {
+            cfg.repetitions = Benchmark::parseCount(a, value());
+        } else if (a == "--format") {
+            cfg.format = Benchmark::parseReportFormat(value());
+        } else if (a == "--out") {
+            cfg.outPath = value();
+        } else if (a == "--drivers") {
+            cfg.driverDir = value();
+        } else if (!a.empty() && a[0] == '-') {
+            throw ParseException("Unknown option: " + a);
+        } else {
+            cfg.inputs.push_back(a);
+        }
+    }
+
+    if (cfg.inputs.empty()) throw ParseException("No inputs given");
+    if (cfg.versions.empty() || cfg.containers.empty()) throw ParseException("Empty version/container list");
+    if (cfg.repetitions < 1) throw ParseException("--reps must be at least 1");
+    return cfg;
+}
+
+} // namespace Compare
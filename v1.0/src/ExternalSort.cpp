@@ -0,0 +1,529 @@
+#include "ExternalSort.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "RecordScanner.h"
+#include "Sorter.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string_view>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace ExternalSort {
+
+// -------------------- OPTIONS --------------------
+
+RunFormat runFormatFromName(const std::string& name) {
+    if (name == "text") return RunFormat::Text;
+    if (name == "binary") return RunFormat::Binary;
+    throw ParseException("Unknown run format: " + name + " (text, binary)");
+}
+
+const char* runFormatName(RunFormat f) {
+    return f == RunFormat::Text ? "text" : "binary";
+}
+
+std::size_t sizeFromText(const std::string& text) {
+    // stoull would skip blanks and wrap a leading '-' around to a huge size
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])))
+        throw ParseException("Invalid size: " + text);
+    std::size_t used = 0;
+    unsigned long long v = 0;
+    try {
+        v = std::stoull(text, &used);
+    } catch (...) {
+        throw ParseException("Invalid size: " + text);
+    }
+    const std::string suffix = text.substr(used);
+    unsigned shift = 0;
+    if (suffix == "K" || suffix == "k") shift = 10;
+    else if (suffix == "M" || suffix == "m") shift = 20;
+    else if (suffix == "G" || suffix == "g") shift = 30;
+    else if (!suffix.empty()) throw ParseException("Invalid size: " + text);
+    if (v > (std::numeric_limits<std::size_t>::max() >> shift)) throw ParseException("Size too large: " + text);
+    return static_cast<std::size_t>(v) << shift;
+}
+
+// -------------------- RECORD FORMS --------------------
+
+// A binary run record is its length, then the exam, the name length and
+// bytes, the surname length and bytes, the homework count and the homework
+// grades; every number is a varint (grades zigzag-encoded, as they may be
+// negative). The final grade is recomputed on reading, as for text runs, so
+// a typical record takes fewer bytes than its text line.
+static void putVarint(std::string& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out += static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+static std::size_t varintSize(std::uint64_t v) {
+    std::size_t n = 1;
+    for (; v >= 0x80; v >>= 7) ++n;
+    return n;
+}
+
+// Reads a varint from [p, end); false when it runs past end or past 64 bits.
+static bool getVarint(const char*& p, const char* end, std::uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        const auto b = static_cast<unsigned char>(*p++);
+        v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+        if (b < 0x80) return true;
+    }
+    return false;
+}
+
+static std::uint64_t zigzag(int v) {
+    return (static_cast<std::uint64_t>(static_cast<std::int64_t>(v)) << 1) ^ static_cast<std::uint64_t>(v < 0 ? -1 : 0);
+}
+
+static int unzigzag(std::uint64_t v) {
+    return static_cast<int>(static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1));
+}
+
+inline constexpr std::size_t MAX_VARINT = 10;
+
+static void appendInt(std::string& out, int v) {
+    char buf[16];
+    const auto res = std::to_chars(buf, buf + sizeof buf, v);
+    out.append(buf, res.ptr);
+}
+
+// What Person's operator<< writes, plus the newline
+static void appendStudentLine(std::string& out, const Student& s) {
+    out.append(s.getName());
+    out += ' ';
+    out.append(s.getSurname());
+    for (int h : s.getHomework()) {
+        out += ' ';
+        appendInt(out, h);
+    }
+    out += ' ';
+    appendInt(out, s.getExam());
+    out += '\n';
+}
+
+static void encode(std::string& out, const Student& s, RunFormat format) {
+    if (format == RunFormat::Text) return appendStudentLine(out, s);
+    const auto& hw = s.getHomework();
+    std::size_t length = varintSize(zigzag(s.getExam())) + varintSize(s.getName().size()) + s.getName().size()
+                         + varintSize(s.getSurname().size()) + s.getSurname().size() + varintSize(hw.size());
+    for (int h : hw) length += varintSize(zigzag(h));
+    putVarint(out, length);
+    putVarint(out, zigzag(s.getExam()));
+    putVarint(out, s.getName().size());
+    out.append(s.getName());
+    putVarint(out, s.getSurname().size());
+    out.append(s.getSurname());
+    putVarint(out, hw.size());
+    for (int h : hw) putVarint(out, zigzag(h));
+}
+
+// Estimated bytes a record holds while its run is built and sorted: the
+// object, its heap strings (libstdc++ keeps up to 15 chars inline), its
+// grades and its share of the sort's key and pointer arrays.
+static std::size_t footprint(const Student& s) {
+    auto heap = [](const std::string& t) { return t.capacity() > 15 ? t.capacity() + 1 : 0; };
+    return sizeof(Student) + heap(s.getName()) + heap(s.getSurname()) + s.getHomework().capacity() * sizeof(int)
+           + sizeof(Sorter::PackedKey) + sizeof(const Student*);
+}
+
+inline constexpr std::size_t OUT_BLOCK = 1 << 20;
+
+// An output file written in OUT_BLOCK pieces
+class OutputFile {
+public:
+    explicit OutputFile(const std::string& path) : path_(path), out_(path, std::ios::binary | std::ios::trunc) {
+        if (!out_.is_open()) throw FileException("Cannot open file for writing: " + path);
+        buf_.reserve(OUT_BLOCK + 4096);
+    }
+
+    std::string& buffer() { return buf_; }
+
+    std::uint64_t written() const { return written_ + buf_.size(); }
+
+    void maybeFlush() {
+        if (buf_.size() >= OUT_BLOCK) flush();
+    }
+
+    void close() {
+        flush();
+        out_.close();
+        if (!out_) throw FileException("Cannot write file: " + path_);
+    }
+
+private:
+    void flush() {
+        out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+        written_ += buf_.size();
+        buf_.clear();
+    }
+
+    std::string path_;
+    std::ofstream out_;
+    std::string buf_;
+    std::uint64_t written_ = 0;
+};
+
+// -------------------- RUN READER --------------------
+
+// Streams one run's records in block-sized reads. The views stay valid until
+// the next call to next().
+class RunReader {
+public:
+    RunReader(const std::string& path, RunFormat format, std::size_t block)
+        : path_(path), in_(path, std::ios::binary), format_(format), block_(block) {
+        if (!in_.is_open()) throw FileException("Cannot open run: " + path);
+    }
+
+    bool next() { return format_ == RunFormat::Text ? nextText() : nextBinary(); }
+
+    bool done() const { return done_; }
+    double grade() const { return grade_; }
+    std::string_view name() const { return name_; }
+    std::string_view surname() const { return surname_; }
+
+    // The record as stored (a text run's line without its newline)
+    std::string_view raw() const { return raw_; }
+
+    // Appends the record as a student line with its newline.
+    void appendLine(std::string& out) const {
+        if (format_ == RunFormat::Text) {
+            out.append(raw_);
+            out += '\n';
+            return;
+        }
+        out.append(name_);
+        out += ' ';
+        out.append(surname_);
+        for (int h : record_.homework) {
+            out += ' ';
+            appendInt(out, h);
+        }
+        out += ' ';
+        appendInt(out, record_.exam);
+        out += '\n';
+    }
+
+private:
+    // At least n unread bytes in buf_ unless the run ends first; reading
+    // moves the unread bytes to the front (pos_ becomes 0).
+    bool fill(std::size_t n) {
+        while (buf_.size() - pos_ < n && !eof_) {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+            const std::size_t have = buf_.size();
+            const std::size_t want = std::max(block_, n - have);
+            buf_.resize(have + want);
+            in_.read(&buf_[have], static_cast<std::streamsize>(want));
+            const auto got = static_cast<std::size_t>(in_.gcount());
+            buf_.resize(have + got);
+            eof_ = got < want;
+        }
+        return buf_.size() - pos_ >= n;
+    }
+
+    bool nextText() {
+        for (;;) {
+            std::size_t from = pos_;
+            std::size_t nl;
+            while ((nl = buf_.find('\n', from)) == std::string::npos && !eof_) {
+                from = buf_.size() - pos_;
+                fill(from + 1);
+            }
+            if (nl == std::string::npos) {
+                if (pos_ == buf_.size()) return finish();
+                nl = buf_.size();
+            }
+            raw_ = std::string_view(buf_).substr(pos_, nl - pos_);
+            pos_ = std::min(nl + 1, buf_.size());
+            if (!RecordScanner::parseLine(raw_, record_)) continue;
+            grade_ = record_.finalAvg();
+            name_ = record_.name;
+            surname_ = record_.surname;
+            return true;
+        }
+    }
+
+    bool nextBinary() {
+        fill(MAX_VARINT);
+        if (pos_ == buf_.size()) return finish();
+        const char* p = buf_.data() + pos_;
+        std::uint64_t length;
+        if (!getVarint(p, buf_.data() + buf_.size(), length)) throw FileException("Corrupt run: " + path_);
+        const auto prefix = static_cast<std::size_t>(p - (buf_.data() + pos_));
+        if (!fill(prefix + length)) throw FileException("Truncated run: " + path_);
+
+        p = buf_.data() + pos_ + prefix; // fill may have moved the buffer
+        const char* end = p + length;
+        raw_ = std::string_view(buf_.data() + pos_, prefix + length);
+        std::uint64_t v, nameLength, surnameLength, count;
+        bool ok = getVarint(p, end, v);
+        record_.exam = unzigzag(v);
+        ok = ok && getVarint(p, end, nameLength) && nameLength <= static_cast<std::uint64_t>(end - p);
+        if (ok) {
+            name_ = std::string_view(p, nameLength);
+            p += nameLength;
+        }
+        ok = ok && getVarint(p, end, surnameLength) && surnameLength <= static_cast<std::uint64_t>(end - p);
+        if (ok) {
+            surname_ = std::string_view(p, surnameLength);
+            p += surnameLength;
+        }
+        ok = ok && getVarint(p, end, count) && count <= static_cast<std::uint64_t>(end - p);
+        record_.homework.clear();
+        for (std::uint64_t i = 0; ok && i < count; ++i) {
+            ok = getVarint(p, end, v);
+            record_.homework.push_back(unzigzag(v));
+        }
+        if (!ok || p != end) throw FileException("Corrupt run: " + path_);
+        grade_ = record_.finalAvg();
+        pos_ += prefix + length;
+        return true;
+    }
+
+    bool finish() {
+        done_ = true;
+        raw_ = name_ = surname_ = {};
+        return false;
+    }
+
+    std::string path_;
+    std::ifstream in_;
+    RunFormat format_;
+    std::size_t block_;
+    std::string buf_;
+    std::size_t pos_ = 0;
+    bool eof_ = false;
+    bool done_ = false;
+
+    std::string_view raw_;
+    std::string_view name_;
+    std::string_view surname_;
+    double grade_ = 0.0;
+    RecordScanner::Record record_; // the current record's fields (names: text runs only)
+};
+
+// -------------------- LOSER TREE --------------------
+
+// Tournament over k runs: node 0 holds the current winner, nodes 1..k-1 the
+// loser of the match played there, leaves are the runs (node k + i is run i).
+// After the winner advances, one replay up its path of log2(k) matches finds
+// the next winner, against 2 log2(k) comparisons for a binary heap.
+class LoserTree {
+public:
+    LoserTree(const std::vector<RunReader>& runs, bool total)
+        : runs_(runs), total_(total), tree_(std::max<std::size_t>(runs.size(), 1)) {
+        tree_[0] = build(1);
+    }
+
+    std::size_t winner() const { return tree_[0]; }
+
+    // After runs[winner()] moved to its next record
+    void replay() {
+        const std::size_t k = runs_.size();
+        std::size_t w = tree_[0];
+        for (std::size_t node = (w + k) / 2; node > 0; node /= 2)
+            if (beats(tree_[node], w)) std::swap(tree_[node], w);
+        tree_[0] = w;
+    }
+
+private:
+    // Sorter's order: grade descending (then surname and name for the total
+    // order); ties go to the earlier run, which holds the earlier input.
+    bool beats(std::size_t a, std::size_t b) const {
+        const RunReader& x = runs_[a];
+        const RunReader& y = runs_[b];
+        if (x.done() || y.done()) return !x.done();
+        if (x.grade() != y.grade()) return x.grade() > y.grade();
+        if (total_) {
+            if (int c = x.surname().compare(y.surname())) return c < 0;
+            if (int c = x.name().compare(y.name())) return c < 0;
+        }
+        return a < b;
+    }
+
+    std::size_t build(std::size_t node) {
+        const std::size_t k = runs_.size();
+        if (node >= k) return node - k;
+        const std::size_t a = build(2 * node);
+        const std::size_t b = build(2 * node + 1);
+        const bool aWins = beats(a, b);
+        tree_[node] = aWins ? b : a;
+        return aWins ? a : b;
+    }
+
+    const std::vector<RunReader>& runs_;
+    bool total_;
+    std::vector<std::size_t> tree_;
+};
+
+// Feeds sink(const RunReader&) every record of the runs in merged order.
+template <typename Sink>
+static void mergeRuns(const std::vector<std::string>& paths, RunFormat format, std::size_t block, bool total,
+                      Sink sink) {
+    std::vector<RunReader> runs;
+    runs.reserve(paths.size()); // the readers' views must not move
+    for (const auto& p : paths) {
+        runs.emplace_back(p, format, block);
+        runs.back().next();
+    }
+    LoserTree tree(runs, total);
+    for (std::size_t w = tree.winner(); !runs[w].done(); w = tree.winner()) {
+        sink(runs[w]);
+        runs[w].next();
+        tree.replay();
+    }
+}
+
+// -------------------- SORT --------------------
+
+TempDir::TempDir(const std::string& parent, const std::string& prefix) {
+    static std::atomic<unsigned> counter{0};
+    const fs::path base = parent.empty() ? fs::temp_directory_path() : fs::path(parent);
+    path_ = base / (prefix + "-" + std::to_string(::getpid()) + "-" + std::to_string(counter++));
+    std::error_code ec;
+    fs::create_directories(path_, ec);
+    if (ec) throw FileException("Cannot create temporary directory: " + path_.string());
+}
+
+TempDir::~TempDir() {
+    std::error_code ec;
+    fs::remove_all(path_, ec);
+}
+
+Result sortFiles(const std::vector<std::string>& inputs, const std::string& outPass, const std::string& outFail,
+                 const Config& cfg) {
+    Trace::Span span("external sort", "extsort");
+    Result res;
+    TempDir temp(cfg.tempDir);
+    const std::size_t memory = std::max(cfg.memoryBytes, MIN_MEMORY);
+    const bool total = Sorter::order() == Sorter::SortOrder::Total;
+    const char* ext = cfg.runFormat == RunFormat::Text ? ".txt" : ".bin";
+
+    // ---- runs: read until the budget is used, sort, spill
+    Trace::Span runSpan("build runs", "extsort");
+    std::vector<std::string> runs;
+    std::vector<Student> batch;
+    std::size_t used = 0;
+    auto spill = [&] {
+        Trace::Span spillSpan("sort and spill run", "extsort");
+        Pipeline::ContainerOps<std::vector<Student>>::sort(batch, cfg.threads);
+        runs.push_back(temp.file("run-" + std::to_string(runs.size()) + ext));
+        OutputFile out(runs.back());
+        for (const auto& s : batch) {
+            encode(out.buffer(), s, cfg.runFormat);
+            out.maybeFlush();
+        }
+        res.spilledBytes += out.written();
+        out.close();
+        batch.clear();
+        used = 0;
+    };
+
+    RecordScanner::Record r;
+    for (const auto& input : inputs) {
+        RecordScanner::forEachLine(input, 0, std::numeric_limits<std::uint64_t>::max(), [&](std::string_view line) {
+            if (!RecordScanner::parseLine(line, r)) return;
+            batch.emplace_back(std::string(r.name), std::string(r.surname), r.homework, r.exam);
+            ++res.records;
+            used += footprint(batch.back());
+            if (used >= memory) spill();
+        });
+    }
+
+    OutputFile passed(outPass);
+    OutputFile failed(outFail);
+    if (runs.empty()) { // it all fit: no spill, no merge
+        Pipeline::ContainerOps<std::vector<Student>>::sort(batch, cfg.threads);
+        res.runMs = runSpan.stop();
+        Trace::Span writeSpan("write outputs", "extsort");
+        for (const auto& s : batch) {
+            const bool pass = Pipeline::isPassed(s);
+            res.passed += pass ? 1 : 0;
+            OutputFile& out = pass ? passed : failed;
+            appendStudentLine(out.buffer(), s);
+            out.maybeFlush();
+        }
+        passed.close();
+        failed.close();
+        res.runs = batch.empty() ? 0 : 1;
+        res.mergeMs = writeSpan.stop();
+        return res;
+    }
+    if (!batch.empty()) spill();
+    std::vector<Student>().swap(batch);
+    res.runs = runs.size();
+    res.runMs = runSpan.stop();
+
+    // ---- merge: in groups while there are more runs than the budget's
+    // read buffers allow, then once into the outputs
+    Trace::Span mergeSpan("merge runs", "extsort");
+    const std::size_t fanIn = std::clamp<std::size_t>(memory / MIN_MERGE_BLOCK, 2, MAX_FAN_IN);
+    while (runs.size() > fanIn) {
+        Trace::Span passSpan("merge pass", "extsort");
+        std::vector<std::string> merged;
+        const std::size_t block = std::clamp<std::size_t>(memory / fanIn, MIN_MERGE_BLOCK, MAX_MERGE_BLOCK);
+        for (std::size_t from = 0; from < runs.size(); from += fanIn) {
+            const std::vector<std::string> group(runs.begin() + static_cast<std::ptrdiff_t>(from),
+                                                 runs.begin() + static_cast<std::ptrdiff_t>(std::min(from + fanIn, runs.size())));
+            merged.push_back(temp.file("merge-" + std::to_string(res.mergePasses) + "-" + std::to_string(merged.size()) + ext));
+            OutputFile out(merged.back());
+            mergeRuns(group, cfg.runFormat, block, total, [&](const RunReader& run) {
+                out.buffer().append(run.raw());
+                if (cfg.runFormat == RunFormat::Text) out.buffer() += '\n';
+                out.maybeFlush();
+            });
+            res.spilledBytes += out.written();
+            out.close();
+            std::error_code ec;
+            for (const auto& g : group) fs::remove(g, ec);
+        }
+        runs = std::move(merged);
+        ++res.mergePasses;
+    }
+
+    const std::size_t block = std::clamp<std::size_t>(memory / runs.size(), MIN_MERGE_BLOCK, MAX_MERGE_BLOCK);
+    mergeRuns(runs, cfg.runFormat, block, total, [&](const RunReader& run) {
+        const bool pass = run.grade() >= Pipeline::PASS_CUTOFF;
+        res.passed += pass ? 1 : 0;
+        OutputFile& out = pass ? passed : failed;
+        run.appendLine(out.buffer());
+        out.maybeFlush();
+    });
+    passed.close();
+    failed.close();
+    res.mergeMs = mergeSpan.stop();
+    return res;
+}
+
+std::uint64_t mergeSortedFiles(const std::vector<std::string>& inputs, const std::string& out) {
+    Trace::Span span("merge sorted files", "extsort");
+    if (inputs.size() > MAX_FAN_IN) throw FileException("Too many files to merge at once");
+    std::uint64_t records = 0;
+    OutputFile file(out);
+    const std::size_t block =
+        std::clamp<std::size_t>((64 << 20) / std::max<std::size_t>(inputs.size(), 1), MIN_MERGE_BLOCK, MAX_MERGE_BLOCK);
+    if (!inputs.empty())
+        mergeRuns(inputs, RunFormat::Text, block, Sorter::order() == Sorter::SortOrder::Total,
+                  [&](const RunReader& run) {
+                      run.appendLine(file.buffer());
+                      file.maybeFlush();
+                      ++records;
+                  });
+    file.close();
+    return records;
+}
+
+} // namespace ExternalSort
@@ -1,41 +1,498 @@
 #include "FileGenerator.h"
 #include "ExceptionHandlers.h"
+#include "Trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <random>
+#include <ostream>
+#include <thread>
 
 namespace fs = std::filesystem;
 
 namespace FileGenerator {
 
+static constexpr std::uint64_t RECORDS_PER_BLOCK = 1 << 16;
+
+// SplitMix64: a counter-based generator, so record i can be produced without
+// generating records 1..i-1 first.
+static inline std::uint64_t mix64(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+class RecordRng {
+public:
+    RecordRng(std::uint64_t seed, std::uint64_t record)
+        : state_(mix64(seed ^ mix64(record))) {}
+
+    std::uint64_t next() {
+        state_ += 0x9E3779B97F4A7C15ULL;
+        return mix64(state_);
+    }
+
+    // Grades 0..10, four per 64-bit draw (16 bits each, multiply-shift mapped).
+    int grade() {
+        if (left_ == 0) {
+            bits_ = next();
+            left_ = 4;
+        }
+        int g = static_cast<int>(((bits_ & 0xFFFF) * 11) >> 16);
+        bits_ >>= 16;
+        --left_;
+        return g;
+    }
+
+    // uniform in [lo, hi]
+    int between(int lo, int hi) {
+        auto span = static_cast<std::uint64_t>(hi - lo + 1);
+        return lo + static_cast<int>(((next() >> 32) * span) >> 32);
+    }
+
+    bool chance(double p) {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53 < p;
+    }
+
+private:
+    std::uint64_t state_;
+    std::uint64_t bits_ = 0;
+    int left_ = 0;
+};
+
+// -------------------- PROFILES --------------------
+
+enum class NameStyle { Sequential, Lithuanian, Long, Utf8, Mixed };
+enum class RecordOrder { Random, Sorted, NearlySorted };
+
+struct ProfileSpec {
+    int hwMin = 5;
+    int hwMax = 5;
+    double passRatio = -1.0; // < 0: every grade uniform in 0..10
+    NameStyle names = NameStyle::Sequential;
+    std::uint32_t surnamePool = 0; // 0: unique surname per record
+    RecordOrder order = RecordOrder::Random;
+    bool padded = false;
+};
+
+static const char* const PROFILE_NAMES[] = {
+    "uniform", "skewed-pass", "skewed-fail", "variable-hw", "long-names", "utf8-names",
+    "dup-surnames", "sorted", "nearly-sorted", "students", "realistic"
+};
+
+std::vector<WorkloadProfile> allProfiles() {
+    std::vector<WorkloadProfile> out;
+    for (int i = 0; i <= static_cast<int>(WorkloadProfile::Realistic); ++i)
+        out.push_back(static_cast<WorkloadProfile>(i));
+    return out;
+}
+
+std::string profileName(WorkloadProfile p) {
+    return PROFILE_NAMES[static_cast<int>(p)];
+}
+
+WorkloadProfile profileFromName(const std::string& name) {
+    for (auto p : allProfiles()) {
+        if (profileName(p) == name) return p;
+    }
+    throw GeneratorException("Unknown workload profile: " + name);
+}
+
+static ProfileSpec resolveProfile(const GeneratorOptions& opts) {
+    ProfileSpec s;
+    s.hwMin = s.hwMax = opts.hwPerStudent;
+    s.padded = opts.paddedLayout;
+
+    switch (opts.profile) {
+    case WorkloadProfile::Uniform: break;
+    case WorkloadProfile::SkewedPass: s.passRatio = 0.9; break;
+    case WorkloadProfile::SkewedFail: s.passRatio = 0.1; break;
+    case WorkloadProfile::VariableHomework: s.hwMin = 0; s.hwMax = 2 * opts.hwPerStudent; break;
+    case WorkloadProfile::LongNames: s.names = NameStyle::Long; break;
+    case WorkloadProfile::Utf8Names: s.names = NameStyle::Utf8; break;
+    case WorkloadProfile::DuplicateSurnames: s.surnamePool = 100; break;
+    case WorkloadProfile::Sorted: s.order = RecordOrder::Sorted; break;
+    case WorkloadProfile::NearlySorted: s.order = RecordOrder::NearlySorted; break;
+    case WorkloadProfile::Students:
+        s.names = NameStyle::Lithuanian;
+        s.padded = true;
+        break;
+    case WorkloadProfile::Realistic:
+        s.passRatio = 0.8;
+        s.hwMin = std::max(1, opts.hwPerStudent - 3);
+        s.hwMax = opts.hwPerStudent + 5;
+        s.names = NameStyle::Mixed;
+        s.surnamePool = 5000;
+        break;
+    }
+    return s;
+}
+
+static const char* const UTF8_NAMES[] = {
+    "Žygimantas", "Ąžuolas", "Gintarė", "Šarūnas", "Björn", "Zoë", "Łukasz",
+    "Юрий", "Αλέξανδρος", "Søren", "José", "Dağhan", "Ελένη", "Ieva", "Jūratė"
+};
+static const char* const UTF8_SURNAMES[] = {
+    "Kazlauskaitė", "Žukauskas", "Šimkūnas", "Müller", "Øvergård", "Łęcki",
+    "Петров", "Παπαδόπουλος", "Çelik", "Núñez", "Jankūnaitė", "Ąžuolaitis"
+};
+static const char* const SYLLABLES[] = {
+    "ka", "lo", "mi", "nu", "ras", "te", "vy", "zan", "dor", "eli", "fus", "gar"
+};
+
+static constexpr std::size_t MAX_NAME_BYTES = 128;
+
+static char* putText(char* p, const char* text) {
+    std::size_t n = std::strlen(text);
+    std::memcpy(p, text, n);
+    return p + n;
+}
+
+static char* putName(char* p, RecordRng& rng, NameStyle style, bool surname, std::uint64_t n) {
+    if (style == NameStyle::Mixed) {
+        int roll = rng.between(0, 99);
+        style = roll < 10 ? NameStyle::Utf8 : roll < 15 ? NameStyle::Long : NameStyle::Sequential;
+    }
+
+    switch (style) {
+    case NameStyle::Sequential:
+        p = putText(p, surname ? "Surname" : "Name");
+        break;
+    case NameStyle::Lithuanian:
+        p = putText(p, surname ? "Pavarde" : "Vardas");
+        break;
+    case NameStyle::Utf8:
+        p = surname ? putText(p, UTF8_SURNAMES[rng.between(0, std::size(UTF8_SURNAMES) - 1)])
+                    : putText(p, UTF8_NAMES[rng.between(0, std::size(UTF8_NAMES) - 1)]);
+        break;
+    case NameStyle::Long: {
+        p = putText(p, surname ? "Surname" : "Name");
+        int syllables = rng.between(6, 25);
+        for (int k = 0; k < syllables; ++k) p = putText(p, SYLLABLES[rng.between(0, std::size(SYLLABLES) - 1)]);
+        break;
+    }
+    case NameStyle::Mixed:
+        break;
+    }
+    return std::to_chars(p, p + 20, n).ptr;
+}
+
+// Fills grades (homework..., exam) for record i of count according to spec.
+static void drawGrades(RecordRng& rng, const ProfileSpec& spec,
+                       std::uint64_t i, std::uint64_t count, std::vector<int>& grades) {
+    const int hw = spec.hwMin == spec.hwMax ? spec.hwMin : rng.between(spec.hwMin, spec.hwMax);
+    grades.resize(static_cast<std::size_t>(hw) + 1);
+
+    if (spec.order != RecordOrder::Random) {
+        // Constant grades per record, stepping down 10..0 across the file.
+        bool displaced = spec.order == RecordOrder::NearlySorted && rng.chance(0.01);
+        int level = displaced ? rng.between(0, 10)
+                              : 10 - static_cast<int>(((i - 1) * 11) / count);
+        std::fill(grades.begin(), grades.end(), level);
+        return;
+    }
+
+    if (spec.passRatio < 0.0) {
+        for (auto& g : grades) g = rng.grade();
+        return;
+    }
+
+    // Passing: everything 5..10. Failing: homework 0..6, exam 0..4, which caps
+    // the final grade at 0.4*6 + 0.6*4 = 4.8.
+    if (rng.chance(spec.passRatio)) {
+        for (auto& g : grades) g = rng.between(5, 10);
+    } else {
+        for (int k = 0; k < hw; ++k) grades[static_cast<std::size_t>(k)] = rng.between(0, 6);
+        grades.back() = rng.between(0, 4);
+    }
+}
+
+static unsigned resolveThreads(unsigned requested) {
+    if (requested != 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+static inline char* putGrade(char* p, int g) {
+    *p++ = ' ';
+    if (g == 10) {
+        *p++ = '1';
+        *p++ = '0';
+    } else {
+        *p++ = static_cast<char>('0' + g);
+    }
+    return p;
+}
+
+// data/Students layout: name and surname share a 32-column field (surname
+// right-aligned), the first grade is right-aligned in 23 columns, the rest in 10.
+static char* putPaddedRecord(char* p, const char* name, std::size_t nameLen,
+                             const char* surname, std::size_t surnameLen,
+                             const std::vector<int>& grades) {
+    std::memcpy(p, name, nameLen);
+    p += nameLen;
+    std::size_t gap = nameLen + surnameLen < 31 ? 32 - nameLen - surnameLen : 1;
+    std::memset(p, ' ', gap);
+    p += gap;
+    std::memcpy(p, surname, surnameLen);
+    p += surnameLen;
+
+    for (std::size_t k = 0; k < grades.size(); ++k) {
+        int width = k == 0 ? 23 : 10;
+        int digits = grades[k] >= 10 ? 2 : 1;
+        std::memset(p, ' ', static_cast<std::size_t>(width - digits));
+        p += width - digits;
+        p = std::to_chars(p, p + 2, grades[k]).ptr;
+    }
+    return p;
+}
+
+// One generated record before formatting; grades are homework..., exam.
+struct RecordFields {
+    char name[MAX_NAME_BYTES + 20];
+    std::size_t nameLen = 0;
+    char surname[MAX_NAME_BYTES + 20];
+    std::size_t surnameLen = 0;
+    std::vector<int> grades;
+};
+
+static void makeRecord(std::uint64_t i, std::uint64_t count, const GeneratorOptions& opts,
+                       const ProfileSpec& spec, RecordFields& rec) {
+    RecordRng rng(opts.seed, i);
+    std::uint64_t surnameNo = spec.surnamePool ? 1 + static_cast<std::uint64_t>(
+                                  rng.between(0, static_cast<int>(spec.surnamePool) - 1)) : i;
+
+    rec.nameLen = static_cast<std::size_t>(putName(rec.name, rng, spec.names, false, i) - rec.name);
+    rec.surnameLen = static_cast<std::size_t>(
+        putName(rec.surname, rng, spec.names, true, surnameNo) - rec.surname);
+    drawGrades(rng, spec, i, count, rec.grades);
+}
+
+// Formats records [first, last] (1-based, inclusive) of count into buf, reusing
+// its capacity. Each record is formatted into a worst-case-sized line and then
+// appended, so the block grows by what the records really take and nothing is
+// zero-filled again on the next round.
+static void formatBlock(std::uint64_t first, std::uint64_t last, std::uint64_t count,
+                        const GeneratorOptions& opts, const ProfileSpec& spec,
+                        std::vector<char>& buf) {
+    Trace::Span span("format block", "generator");
+    const std::size_t maxRecord = 2 * (MAX_NAME_BYTES + 20) + 32
+                                + 23 * (static_cast<std::size_t>(spec.hwMax) + 1) + 1;
+    std::vector<char> line(maxRecord);
+    buf.clear();
+
+    RecordFields rec;
+    for (std::uint64_t i = first; i <= last; ++i) {
+        makeRecord(i, count, opts, spec, rec);
+
+        char* p = line.data();
+        if (spec.padded) {
+            p = putPaddedRecord(p, rec.name, rec.nameLen, rec.surname, rec.surnameLen, rec.grades);
+        } else {
+            std::memcpy(p, rec.name, rec.nameLen);
+            p += rec.nameLen;
+            *p++ = ' ';
+            std::memcpy(p, rec.surname, rec.surnameLen);
+            p += rec.surnameLen;
+            for (int g : rec.grades) p = putGrade(p, g);
+        }
+        *p++ = '\n';
+        buf.insert(buf.end(), line.data(), p);
+    }
+}
+
+static Student toStudent(const RecordFields& rec) {
+    std::vector<int> hw(rec.grades.begin(), rec.grades.end() - 1);
+    return Student(std::string(rec.name, rec.nameLen),
+                   std::string(rec.surname, rec.surnameLen),
+                   hw, rec.grades.back());
+}
+
+// -------------------- WRITERS --------------------
+
 void generateFile(const std::string& outPath, std::uint64_t count, int hwPerStudent) {
+    GeneratorOptions opts;
+    opts.hwPerStudent = hwPerStudent;
+    generateFile(outPath, count, opts);
+}
+
+void generateFile(const std::string& outPath, std::uint64_t count, const GeneratorOptions& opts) {
+    if (outPath == "-") {
+        writeRecords(std::cout, count, opts);
+        std::cout.flush();
+        std::cerr << "Generated: <stdout> (" << count << " records, "
+                  << profileName(opts.profile) << ", seed " << opts.seed << ")\n";
+        return;
+    }
+
     fs::path p(outPath);
     if (p.has_parent_path()) fs::create_directories(p.parent_path());
 
-    std::ofstream out(outPath);
+    std::ofstream out(outPath, std::ios::binary);
     if (!out.is_open()) throw GeneratorException("Cannot open file for writing: " + outPath);
 
-    std::mt19937_64 rng(std::random_device{}());
-    std::uniform_int_distribution<int> grade(0, 10);
+    writeRecords(out, count, opts);
+    if (!out) throw GeneratorException("Write failed: " + outPath);
 
-    for (std::uint64_t i = 1; i <= count; ++i) {
-        out << "Name" << i << " " << "Surname" << i;
-        for (int j = 0; j < hwPerStudent; ++j) out << " " << grade(rng);
-        out << " " << grade(rng) << "\n";
+    std::cout << "Generated: " << outPath << " (" << count << " records, "
+              << profileName(opts.profile) << ", seed " << opts.seed << ", "
+              << resolveThreads(opts.threads) << " threads)\n";
+}
+
+void writeRecords(std::ostream& out, std::uint64_t count, const GeneratorOptions& opts) {
+    Trace::Span span("writeRecords", "generator");
+    if (opts.hwPerStudent < 0) throw GeneratorException("Negative homework count");
+    const ProfileSpec spec = resolveProfile(opts);
+
+    const unsigned threads = resolveThreads(opts.threads);
+    const std::uint64_t blocks = (count + RECORDS_PER_BLOCK - 1) / RECORDS_PER_BLOCK;
+
+    // Each round formats up to `threads` consecutive blocks in parallel while
+    // the previous round's buffers are written out, in block order, by one
+    // writer thread. Two buffer sets alternate between the two roles.
+    std::vector<std::vector<char>> buffers[2] = {
+        std::vector<std::vector<char>>(threads), std::vector<std::vector<char>>(threads)
+    };
+    std::vector<std::thread> pool;
+    std::thread writer;
+    std::vector<std::exception_ptr> formatErrors(threads);
+    std::exception_ptr writeError;
+    auto joinPool = [&] {
+        for (auto& t : pool) t.join();
+        pool.clear();
+    };
+    auto joinWriter = [&] {
+        if (writer.joinable()) writer.join();
+        if (writeError) std::rethrow_exception(writeError);
+    };
+    int cur = 0;
+
+    try {
+        for (std::uint64_t firstBlock = 0; firstBlock < blocks; firstBlock += threads) {
+            const std::uint64_t roundBlocks = std::min<std::uint64_t>(threads, blocks - firstBlock);
+            auto& round = buffers[cur];
+
+            auto work = [&](std::uint64_t k) {
+                try {
+                    std::uint64_t b = firstBlock + k;
+                    std::uint64_t first = b * RECORDS_PER_BLOCK + 1;
+                    std::uint64_t last = std::min(count, (b + 1) * RECORDS_PER_BLOCK);
+                    formatBlock(first, last, count, opts, spec, round[k]);
+                } catch (...) {
+                    formatErrors[k] = std::current_exception();
+                }
+            };
+
+            for (std::uint64_t k = 1; k < roundBlocks; ++k) {
+                pool.emplace_back([&work, k] {
+                    Trace::setThreadName("generator worker");
+                    work(k);
+                });
+            }
+            work(0);
+            joinPool();
+            for (auto& e : formatErrors)
+                if (e) std::rethrow_exception(e);
+
+            joinWriter();
+            writer = std::thread([&out, &round, &writeError, roundBlocks] {
+                Trace::setThreadName("generator writer");
+                Trace::Span span("write round", "generator");
+                try {
+                    for (std::uint64_t k = 0; k < roundBlocks; ++k) {
+                        out.write(round[k].data(), static_cast<std::streamsize>(round[k].size()));
+                    }
+                } catch (...) {
+                    writeError = std::current_exception();
+                }
+            });
+            cur ^= 1;
+        }
+        joinWriter();
+    } catch (const GeneratorException&) {
+        joinPool();
+        if (writer.joinable()) writer.join();
+        throw;
+    } catch (const std::exception& e) {
+        // thread creation, formatting or a stream with exceptions enabled
+        joinPool();
+        if (writer.joinable()) writer.join();
+        throw GeneratorException(std::string("Generating records failed: ") + e.what());
     }
+}
+
+// -------------------- IN-MEMORY SOURCE --------------------
+
+RecordSource::RecordSource(std::uint64_t count, const GeneratorOptions& opts)
+    : count_(count), opts_(opts) {
+    if (opts.hwPerStudent < 0) throw GeneratorException("Negative homework count");
+}
 
-    std::cout << "Generated: " << outPath << " (" << count << " records)\n";
+bool RecordSource::next(Student& out) {
+    if (next_ > count_) return false;
+    RecordFields rec;
+    makeRecord(next_++, count_, opts_, resolveProfile(opts_), rec);
+    out = toStudent(rec);
+    return true;
+}
+
+std::size_t RecordSource::nextBatch(std::vector<Student>& out, std::size_t max) {
+    const std::uint64_t first = next_;
+    const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(max, remaining()));
+    if (n == 0) return 0;
+
+    const std::size_t base = out.size();
+    out.resize(base + n);
+    next_ += n;
+
+    const ProfileSpec spec = resolveProfile(opts_);
+    const unsigned threads = static_cast<unsigned>(
+        std::min<std::size_t>(resolveThreads(opts_.threads), (n + RECORDS_PER_BLOCK - 1) / RECORDS_PER_BLOCK));
+
+    auto work = [&](unsigned t) {
+        Trace::Span span("generate batch", "generator");
+        std::size_t lo = n * t / threads;
+        std::size_t hi = n * (t + 1) / threads;
+        RecordFields rec;
+        for (std::size_t k = lo; k < hi; ++k) {
+            makeRecord(first + k, count_, opts_, spec, rec);
+            out[base + k] = toStudent(rec);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back([&work, t] {
+            Trace::setThreadName("source worker");
+            work(t);
+        });
+    }
+    work(0);
+    for (auto& t : pool) t.join();
+    return n;
 }
 
 void generateFilesForCounts(const std::string& folder,
                             const std::vector<std::uint64_t>& counts,
                             int hwPerStudent) {
-    fs::create_directories(folder);
+    GeneratorOptions opts;
+    opts.hwPerStudent = hwPerStudent;
+    generateFilesForCounts(folder, counts, opts);
+}
+
+void generateFilesForCounts(const std::string& folder,
+                            const std::vector<std::uint64_t>& counts,
+                            const GeneratorOptions& opts) {
+    std::string target = folder;
+    if (opts.profile != WorkloadProfile::Uniform) target += "/" + profileName(opts.profile);
+    fs::create_directories(target);
 
     for (auto c : counts) {
-        std::string path = folder + "/students_" + std::to_string(c) + ".txt";
-        generateFile(path, c, hwPerStudent);
+        std::string path = target + "/students_" + std::to_string(c) + ".txt";
+        generateFile(path, c, opts);
     }
 }
 
@@ -0,0 +1,237 @@
+#include "GradeStats.h"
+#include "Pipeline.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+namespace GradeStats {
+
+// -------------------- GRADES --------------------
+
+bool operator<(const Grade& a, const Grade& b) {
+    // the cross products of out-of-range grades overflow int64
+    return static_cast<__int128>(a.num) * b.den < static_cast<__int128>(b.num) * a.den;
+}
+
+bool operator==(const Grade& a, const Grade& b) {
+    return a.num == b.num && a.den == b.den;
+}
+
+static Grade reduced(std::int64_t num, std::int64_t den) {
+    const std::int64_t g = std::gcd(num, den);
+    return g > 1 ? Grade{num / g, den / g} : Grade{num, den};
+}
+
+Grade finalAvgGrade(long long homeworkSum, std::size_t homeworkCount, int exam) {
+    if (homeworkCount == 0) return reduced(3 * static_cast<std::int64_t>(exam), 5); // avg() is 0 without homework
+    const auto n = static_cast<std::int64_t>(homeworkCount);
+    return reduced(2 * homeworkSum + 3 * static_cast<std::int64_t>(exam) * n, 5 * n);
+}
+
+Grade finalMedGrade(long long twiceMedian, int exam) {
+    return reduced(twiceMedian + 3 * static_cast<std::int64_t>(exam), 5);
+}
+
+// Person::median() times two, without sorting the record's own grades
+static long long twiceMedian(const std::vector<int>& homework) {
+    const std::size_t n = homework.size();
+    if (n == 0) return 0;
+    thread_local std::vector<int> scratch;
+    scratch.assign(homework.begin(), homework.end());
+    auto mid = scratch.begin() + static_cast<std::ptrdiff_t>(n / 2);
+    std::nth_element(scratch.begin(), mid, scratch.end());
+    if (n % 2) return 2LL * *mid;
+    return static_cast<long long>(*mid) + *std::max_element(scratch.begin(), mid);
+}
+
+// -------------------- HISTOGRAM --------------------
+
+void Histogram::add(const Grade& g, std::uint64_t n) {
+    bins_[g] += n;
+    count_ += n;
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (const auto& [g, n] : other.bins_) add(g, n);
+}
+
+Grade Histogram::percentile(double p) const {
+    auto rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(count_)));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+    std::uint64_t seen = 0;
+    for (const auto& [g, n] : bins_) {
+        seen += n;
+        if (seen >= rank) return g;
+    }
+    return max();
+}
+
+double Histogram::mean() const {
+    long double sum = 0;
+    for (const auto& [g, n] : bins_) sum += static_cast<long double>(n) * g.num / g.den;
+    return static_cast<double>(sum / count_);
+}
+
+double Histogram::stddev() const {
+    const long double m = mean();
+    long double sq = 0;
+    for (const auto& [g, n] : bins_) {
+        const long double d = static_cast<long double>(g.num) / g.den - m;
+        sq += static_cast<long double>(n) * d * d;
+    }
+    return static_cast<double>(std::sqrt(sq / count_));
+}
+
+// -------------------- SCAN --------------------
+
+void Stats::add(const RecordScanner::Record& r) {
+    ++records;
+    if (r.finalAvg() >= Pipeline::PASS_CUTOFF) ++passed;
+    finalAvg.add(finalAvgGrade(r.homeworkSum(), r.homework.size(), r.exam));
+    finalMed.add(finalMedGrade(twiceMedian(r.homework), r.exam));
+}
+
+void Stats::merge(const Stats& other) {
+    records += other.records;
+    passed += other.passed;
+    finalAvg.merge(other.finalAvg);
+    finalMed.merge(other.finalMed);
+}
+
+Stats scanFile(const std::string& path, unsigned threads) {
+    Trace::Span span("grade stats file", "stats");
+    const unsigned parts = std::max(threads, 1u);
+    const auto bounds = RecordScanner::lineBounds(path, parts);
+    std::vector<Stats> partial(parts);
+    Pipeline::runParts(parts, "stats worker", [&](unsigned k) {
+        Trace::Span span("scan range", "stats");
+        RecordScanner::forEachRecord(path, bounds[k], bounds[k + 1],
+                                     [&](const RecordScanner::Record& r) { partial[k].add(r); });
+    });
+    for (unsigned k = 1; k < parts; ++k) partial[0].merge(partial[k]);
+    return std::move(partial[0]);
+}
+
+Stats scanFiles(const std::vector<std::string>& paths, unsigned threads) {
+    Stats all;
+    for (const auto& p : paths) all.merge(scanFile(p, threads));
+    return all;
+}
+
+// -------------------- REPORTING --------------------
+
+static double passRate(const Stats& s) {
+    return s.records ? 100.0 * static_cast<double>(s.passed) / static_cast<double>(s.records) : 0.0;
+}
+
+struct Series {
+    const char* name;
+    Histogram Stats::*histogram;
+};
+static const Series SERIES[] = {{"finalAvg", &Stats::finalAvg}, {"finalMed", &Stats::finalMed}};
+
+struct Statistic {
+    const char* name;
+    double (*of)(const Histogram&);
+};
+static const Statistic STATISTICS[] = {
+    {"mean", [](const Histogram& h) { return h.mean(); }},
+    {"stddev", [](const Histogram& h) { return h.stddev(); }},
+    {"min", [](const Histogram& h) { return h.min().value(); }},
+    {"p10", [](const Histogram& h) { return h.percentile(10).value(); }},
+    {"p25", [](const Histogram& h) { return h.percentile(25).value(); }},
+    {"median", [](const Histogram& h) { return h.percentile(50).value(); }},
+    {"p75", [](const Histogram& h) { return h.percentile(75).value(); }},
+    {"p90", [](const Histogram& h) { return h.percentile(90).value(); }},
+    {"max", [](const Histogram& h) { return h.max().value(); }},
+};
+
+// Counts per one-point band [k, k + 1)
+static std::map<long long, std::uint64_t> bands(const Histogram& h) {
+    std::map<long long, std::uint64_t> out;
+    for (const auto& [g, n] : h.bins()) out[static_cast<long long>(std::floor(g.value()))] += n;
+    return out;
+}
+
+static void reportText(std::ostream& out, const std::vector<std::string>& inputs, const Stats& s) {
+    out << "Input:";
+    for (const auto& in : inputs) out << " " << in;
+    out << "\nRecords: " << s.records << "  passed: " << s.passed << "  failed: " << s.records - s.passed
+        << std::fixed << std::setprecision(2) << "  pass rate: " << passRate(s) << "%\n";
+    if (s.records == 0) {
+        out << std::defaultfloat;
+        return;
+    }
+
+    out << "\n" << std::left << std::setw(10) << "" << std::right;
+    for (const auto& series : SERIES) out << std::setw(12) << series.name;
+    out << std::setprecision(4) << "\n";
+    for (const auto& st : STATISTICS) {
+        out << std::left << std::setw(10) << st.name << std::right;
+        for (const auto& series : SERIES) out << std::setw(12) << st.of(s.*series.histogram);
+        out << "\n";
+    }
+    out << std::left << std::setw(10) << "distinct" << std::right;
+    for (const auto& series : SERIES) out << std::setw(12) << (s.*series.histogram).bins().size();
+    out << "\n\n" << std::left << std::setw(10) << "band" << std::right;
+    for (const auto& series : SERIES) out << std::setw(12) << series.name;
+    out << "\n";
+
+    // non-empty bands only: one out-of-range record must not print every
+    // band up to its grade
+    std::map<long long, std::array<std::uint64_t, 2>> rows;
+    for (const auto& [b, n] : bands(s.finalAvg)) rows[b][0] = n;
+    for (const auto& [b, n] : bands(s.finalMed)) rows[b][1] = n;
+    for (const auto& [b, n] : rows) {
+        out << std::left << std::setw(10) << ("[" + std::to_string(b) + "," + std::to_string(b + 1) + ")") << std::right;
+        for (std::uint64_t c : n) out << std::setw(12) << c;
+        out << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+static void reportJson(std::ostream& out, const std::vector<std::string>& inputs, const Stats& s) {
+    out << "{\n  \"inputs\": [";
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+        out << (i ? ", " : "") << "\"" << Benchmark::jsonEscape(inputs[i]) << "\"";
+    out << "],\n  \"records\": " << s.records << ", \"passed\": " << s.passed
+        << ", \"failed\": " << s.records - s.passed << std::setprecision(10) << ", \"passRate\": " << passRate(s);
+    for (const auto& series : SERIES) {
+        const Histogram& h = s.*series.histogram;
+        out << ",\n  \"" << series.name << "\": {\"count\": " << h.count() << ", \"distinct\": " << h.bins().size();
+        if (h.count() > 0)
+            for (const auto& st : STATISTICS) out << ", \"" << st.name << "\": " << st.of(h);
+        out << ",\n    \"bins\": [";
+        bool first = true;
+        for (const auto& [g, n] : h.bins()) {
+            out << (first ? "" : ",") << "\n      {\"num\": " << g.num << ", \"den\": " << g.den
+                << ", \"value\": " << g.value() << ", \"count\": " << n << "}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "\n}\n" << std::defaultfloat;
+}
+
+static void reportCsv(std::ostream& out, const Stats& s) {
+    out << "series,num,den,value,count\n" << std::setprecision(10);
+    for (const auto& series : SERIES)
+        for (const auto& [g, n] : (s.*series.histogram).bins())
+            out << series.name << "," << g.num << "," << g.den << "," << g.value() << "," << n << "\n";
+    out << std::defaultfloat;
+}
+
+void report(std::ostream& out, const std::vector<std::string>& inputs, const Stats& stats,
+            Benchmark::OutputFormat format) {
+    switch (format) {
+    case Benchmark::OutputFormat::Text: reportText(out, inputs, stats); break;
+    case Benchmark::OutputFormat::Json: reportJson(out, inputs, stats); break;
+    case Benchmark::OutputFormat::Csv: reportCsv(out, stats); break;
+    }
+}
+
+} // namespace GradeStats
@@ -0,0 +1,119 @@
+#include "IncrementalDataset.h"
+#include "Pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+struct IncrementalDataset::Impl {
+    struct Key {
+        double grade;
+        Id id;
+    };
+    struct KeyOrder {
+        bool operator()(const Key& a, const Key& b) const {
+            return a.grade != b.grade ? a.grade > b.grade : a.id < b.id;
+        }
+    };
+    using Tree = __gnu_pbds::tree<Key, Student, KeyOrder, __gnu_pbds::rb_tree_tag,
+                                  __gnu_pbds::tree_order_statistics_node_update>;
+
+    // the first failed student's position in the tree
+    Tree::const_iterator firstFailed() const { return tree.find_by_order(passed); }
+
+    Tree tree;
+    std::unordered_map<Id, double> grades; // id -> the grade its key was filed under
+    std::size_t passed = 0;
+    Id nextId = 1;
+};
+
+IncrementalDataset::IncrementalDataset() : impl_(std::make_unique<Impl>()) {}
+IncrementalDataset::~IncrementalDataset() = default;
+IncrementalDataset::IncrementalDataset(IncrementalDataset&&) noexcept = default;
+IncrementalDataset& IncrementalDataset::operator=(IncrementalDataset&&) noexcept = default;
+
+std::size_t IncrementalDataset::size() const {
+    return impl_->tree.size();
+}
+
+std::size_t IncrementalDataset::passed() const {
+    return impl_->passed;
+}
+
+IncrementalDataset::Id IncrementalDataset::add(Student s) {
+    Impl& d = *impl_;
+    if (s.finalAvgCached() < 0.0) s.computeCache();
+    const Id id = d.nextId++;
+    const double grade = s.finalAvgCached();
+    if (Pipeline::isPassed(s)) ++d.passed;
+    d.tree.insert({Impl::Key{grade, id}, std::move(s)});
+    d.grades.emplace(id, grade);
+    return id;
+}
+
+bool IncrementalDataset::update(Id id, const std::vector<int>& homework, int exam) {
+    Impl& d = *impl_;
+    auto g = d.grades.find(id);
+    if (g == d.grades.end()) return false;
+    auto it = d.tree.find(Impl::Key{g->second, id});
+    Student s(it->second.getName(), it->second.getSurname(), homework, exam);
+
+    d.passed -= Pipeline::isPassed(it->second) ? 1 : 0;
+    d.passed += Pipeline::isPassed(s) ? 1 : 0;
+    d.tree.erase(it);
+    g->second = s.finalAvgCached();
+    d.tree.insert({Impl::Key{g->second, id}, std::move(s)});
+    return true;
+}
+
+bool IncrementalDataset::remove(Id id) {
+    Impl& d = *impl_;
+    auto g = d.grades.find(id);
+    if (g == d.grades.end()) return false;
+    auto it = d.tree.find(Impl::Key{g->second, id});
+    if (Pipeline::isPassed(it->second)) --d.passed;
+    d.tree.erase(it);
+    d.grades.erase(g);
+    return true;
+}
+
+const Student* IncrementalDataset::find(Id id) const {
+    auto g = impl_->grades.find(id);
+    if (g == impl_->grades.end()) return nullptr;
+    return &impl_->tree.find(Impl::Key{g->second, id})->second;
+}
+
+std::size_t IncrementalDataset::rankOf(Id id) const {
+    return impl_->tree.order_of_key(Impl::Key{impl_->grades.at(id), id});
+}
+
+const Student& IncrementalDataset::byRank(std::size_t rank) const {
+    return impl_->tree.find_by_order(rank)->second;
+}
+
+IncrementalDataset::Id IncrementalDataset::idAt(std::size_t rank) const {
+    return impl_->tree.find_by_order(rank)->first.id;
+}
+
+double IncrementalDataset::percentile(double p) const {
+    const auto& tree = impl_->tree;
+    if (tree.empty()) return 0.0;
+    const std::size_t n = tree.size();
+    // nearest rank in ascending order; the tree is descending
+    auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+    rank = std::clamp<std::size_t>(rank, 1, n);
+    return tree.find_by_order(n - rank)->first.grade;
+}
+
+void IncrementalDataset::forEachPassed(const std::function<void(Id, const Student&)>& f) const {
+    const Impl& d = *impl_;
+    for (auto it = d.tree.begin(), end = d.firstFailed(); it != end; ++it) f(it->first.id, it->second);
+}
+
+void IncrementalDataset::forEachFailed(const std::function<void(Id, const Student&)>& f) const {
+    const Impl& d = *impl_;
+    for (auto it = d.firstFailed(); it != d.tree.end(); ++it) f(it->first.id, it->second);
+}
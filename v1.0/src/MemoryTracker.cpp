@@ -0,0 +1,163 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+namespace MemoryTracker {
+
+static std::atomic<int> enabledState{-1}; // -1: not yet read from the environment
+static std::atomic<bool> counting{false};
+
+static std::atomic<std::uint64_t> allocCount{0};
+static std::atomic<std::uint64_t> allocBytes{0};
+static std::atomic<std::int64_t> liveBytes{0};
+static std::atomic<std::int64_t> peakLive{0};
+
+bool enabled() {
+    int s = enabledState.load(std::memory_order_relaxed);
+    if (s < 0) {
+        const char* env = std::getenv("SGC_MEM_TRACKING");
+        s = (env && *env && std::strcmp(env, "0") != 0) ? 1 : 0;
+        enabledState.store(s, std::memory_order_relaxed);
+        counting.store(s == 1, std::memory_order_relaxed);
+    }
+    return s == 1;
+}
+
+void setEnabled(bool on) {
+    enabledState.store(on ? 1 : 0, std::memory_order_relaxed);
+    counting.store(on, std::memory_order_relaxed);
+}
+
+bool hooksInstalled() {
+#ifdef SGC_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Live bytes use the usable block size so that frees (which only know the
+// pointer) subtract exactly what the allocation added.
+static inline void onAlloc(void* p, std::size_t requested) {
+    if (!p || !counting.load(std::memory_order_relaxed)) return;
+    auto n = static_cast<std::int64_t>(malloc_usable_size(p));
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(requested, std::memory_order_relaxed);
+    std::int64_t live = liveBytes.fetch_add(n, std::memory_order_relaxed) + n;
+    std::int64_t peak = peakLive.load(std::memory_order_relaxed);
+    while (live > peak && !peakLive.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+static inline void onFree(void* p) {
+    if (!p || !counting.load(std::memory_order_relaxed)) return;
+    liveBytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(p)), std::memory_order_relaxed);
+}
+
+// Linux resets VmHWM when "5" is written to clear_refs; elsewhere the
+// peak is the process lifetime maximum.
+static void resetPeakRss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+static std::uint64_t peakRssKb() {
+    std::ifstream in("/proc/self/status");
+    std::string key;
+    while (in >> key) {
+        if (key == "VmHWM:") {
+            std::uint64_t kb = 0;
+            in >> kb;
+            return kb;
+        }
+        in.ignore(4096, '\n');
+    }
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<std::uint64_t>(ru.ru_maxrss);
+}
+
+Scope::Scope() {
+    resetPeakRss();
+    allocations_ = allocCount.load(std::memory_order_relaxed);
+    bytes_ = allocBytes.load(std::memory_order_relaxed);
+    liveAtStart_ = liveBytes.load(std::memory_order_relaxed);
+    peakLive.store(liveAtStart_, std::memory_order_relaxed);
+}
+
+MemStats Scope::stop() {
+    MemStats m;
+    m.valid = true;
+    m.allocations = allocCount.load(std::memory_order_relaxed) - allocations_;
+    m.bytesAllocated = allocBytes.load(std::memory_order_relaxed) - bytes_;
+    std::int64_t peak = peakLive.load(std::memory_order_relaxed) - liveAtStart_;
+    m.peakLiveBytes = peak > 0 ? static_cast<std::uint64_t>(peak) : 0;
+    m.peakRssKb = peakRssKb();
+    return m;
+}
+
+} // namespace MemoryTracker
+
+// -------------------- GLOBAL OPERATOR NEW / DELETE --------------------
+
+#ifdef SGC_ALLOC_TRACKING
+
+static void* trackedAlloc(std::size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    MemoryTracker::onAlloc(p, n);
+    return p;
+}
+
+static void* trackedAlignedAlloc(std::size_t n, std::align_val_t al) {
+    auto a = static_cast<std::size_t>(al);
+    void* p = std::aligned_alloc(a, ((n ? n : 1) + a - 1) / a * a);
+    MemoryTracker::onAlloc(p, n);
+    return p;
+}
+
+static void trackedFree(void* p) {
+    MemoryTracker::onFree(p);
+    std::free(p);
+}
+
+void* operator new(std::size_t n) {
+    if (void* p = trackedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) {
+    if (void* p = trackedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return trackedAlloc(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return trackedAlloc(n); }
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    if (void* p = trackedAlignedAlloc(n, al)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t al) {
+    if (void* p = trackedAlignedAlloc(n, al)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { trackedFree(p); }
+
+#endif
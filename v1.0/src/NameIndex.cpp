@@ -0,0 +1,125 @@
+#include "NameIndex.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <functional>
+
+#if defined(__GNUC__)
+#define SGC_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define SGC_PREFETCH(p) ((void)(p))
+#endif
+
+static const std::size_t MIN_CAPACITY = 16;
+static const std::size_t PARALLEL_SLICE = 1 << 14; // fewer records per thread: build single-threaded
+static const std::size_t BATCH = 16;               // keys in flight per findBatch group
+
+static std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static std::uint32_t tagOf(std::uint64_t hash) { return static_cast<std::uint32_t>(hash >> 32); }
+static std::uint32_t slotTag(std::uint64_t slot) { return static_cast<std::uint32_t>(slot >> 32); }
+static std::uint32_t slotPos(std::uint64_t slot) { return static_cast<std::uint32_t>(slot) - 1; }
+
+std::uint64_t NameIndex::hashKey(std::string_view name, std::string_view surname) {
+    std::hash<std::string_view> h;
+    return mix(h(surname) ^ mix(h(name)));
+}
+
+NameIndex::NameIndex(const std::vector<Student>& students, unsigned threads)
+    : records_(students.data()), size_(students.size()) {
+    Trace::Span span("name index build", "index");
+    // positions are 32 bits in a slot (stored + 1) and in every result
+    if (size_ >= UINT32_MAX) throw FileException("Too many records for the name index");
+    std::size_t cap = MIN_CAPACITY;
+    while (cap * 7 < size_ * 10) cap <<= 1; // load factor <= 0.7
+    mask_ = cap - 1;
+    slots_.reset(new std::atomic<std::uint64_t>[cap]);
+    for (std::size_t i = 0; i < cap; ++i) slots_[i].store(0, std::memory_order_relaxed);
+
+    auto insertRange = [&](std::size_t from, std::size_t to) {
+        for (std::size_t i = from; i < to; ++i) {
+            std::uint64_t hash = hashKey(students[i].getName(), students[i].getSurname());
+            std::uint64_t slot = (static_cast<std::uint64_t>(tagOf(hash)) << 32) | (i + 1);
+            for (std::uint64_t j = hash & mask_;; j = (j + 1) & mask_) {
+                std::uint64_t expected = 0;
+                if (slots_[j].load(std::memory_order_relaxed) == 0
+                    && slots_[j].compare_exchange_strong(expected, slot, std::memory_order_relaxed))
+                    break;
+            }
+        }
+    };
+
+    unsigned parts = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), size_ / PARALLEL_SLICE + 1));
+    if (parts <= 1) {
+        insertRange(0, size_);
+        return;
+    }
+    // runParts joins every worker, which orders the relaxed stores before any lookup
+    Pipeline::runParts(parts, "index worker", [&](unsigned k) {
+        insertRange(size_ * k / parts, size_ * (k + 1) / parts);
+    });
+}
+
+template <typename F>
+void NameIndex::probe(const Key& key, std::uint64_t hash, F onMatch) const {
+    const std::uint32_t tag = tagOf(hash);
+    for (std::uint64_t j = hash & mask_;; j = (j + 1) & mask_) {
+        std::uint64_t slot = slots_[j].load(std::memory_order_relaxed);
+        if (slot == 0) return;
+        if (slotTag(slot) != tag) continue;
+        const Student& s = records_[slotPos(slot)];
+        if (s.getName() == key.name && s.getSurname() == key.surname) onMatch(slotPos(slot));
+    }
+}
+
+std::vector<std::uint32_t> NameIndex::find(std::string_view name, std::string_view surname) const {
+    std::vector<std::uint32_t> out;
+    if (size_ == 0) return out;
+    Key key{name, surname};
+    probe(key, hashKey(name, surname), [&](std::uint32_t pos) { out.push_back(pos); });
+    std::sort(out.begin(), out.end()); // parallel builds fill probe runs in any order
+    return out;
+}
+
+// Three passes per group of keys: hash all and prefetch their home slots, then
+// prefetch the record each home slot points at, then resolve. Each pass only
+// touches lines requested by the one before, so the misses of a group overlap
+// instead of being paid one key at a time.
+NameIndex::BatchResult NameIndex::findBatch(const std::vector<Key>& keys) const {
+    BatchResult r;
+    r.offsets.reserve(keys.size() + 1);
+    r.offsets.push_back(0);
+    std::uint64_t hashes[BATCH];
+
+    for (std::size_t base = 0; base < keys.size(); base += BATCH) {
+        const std::size_t n = std::min(BATCH, keys.size() - base);
+        if (size_ == 0) {
+            r.offsets.insert(r.offsets.end(), n, 0);
+            continue;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            hashes[i] = hashKey(keys[base + i].name, keys[base + i].surname);
+            SGC_PREFETCH(&slots_[hashes[i] & mask_]);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t slot = slots_[hashes[i] & mask_].load(std::memory_order_relaxed);
+            if (slot != 0 && slotTag(slot) == tagOf(hashes[i])) SGC_PREFETCH(&records_[slotPos(slot)]);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t first = r.positions.size();
+            probe(keys[base + i], hashes[i], [&](std::uint32_t pos) { r.positions.push_back(pos); });
+            std::sort(r.positions.begin() + static_cast<std::ptrdiff_t>(first), r.positions.end());
+            r.offsets.push_back(static_cast<std::uint32_t>(r.positions.size()));
+        }
+    }
+    return r;
+}
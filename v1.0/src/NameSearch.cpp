@@ -0,0 +1,180 @@
+#include "NameSearch.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+static const char SEP = '\n';
+static const std::size_t PARALLEL_SLICE = 1 << 14; // fewer records per thread: build single-threaded
+
+// Names never contain whitespace, and the index relies on it.
+static bool searchable(std::string_view pattern) {
+    return std::none_of(pattern.begin(), pattern.end(), [](char c) { return static_cast<unsigned char>(c) <= ' '; });
+}
+
+static bool fieldMatches(const std::string& field, std::string_view pattern, bool prefix) {
+    if (prefix) return field.compare(0, pattern.size(), pattern) == 0;
+    return std::search(field.begin(), field.end(), pattern.begin(), pattern.end()) != field.end();
+}
+
+static bool recordMatches(const Student& s, std::string_view pattern, bool prefix, NameSearch::Field field) {
+    return (field != NameSearch::Field::Surname && fieldMatches(s.getName(), pattern, prefix))
+        || (field != NameSearch::Field::Name && fieldMatches(s.getSurname(), pattern, prefix));
+}
+
+static std::vector<std::uint32_t> scan(const Student* students, std::size_t n, std::string_view pattern, bool prefix,
+                                       NameSearch::Field field) {
+    std::vector<std::uint32_t> out;
+    if (!searchable(pattern)) return out;
+    for (std::size_t i = 0; i < n; ++i)
+        if (recordMatches(students[i], pattern, prefix, field)) out.push_back(static_cast<std::uint32_t>(i));
+    return out;
+}
+
+// Calls f once per distinct trigram of "\n<name>" and "\n<surname>".
+template <typename F>
+void NameSearch::forEachTrigram(const Student& s, std::vector<std::uint32_t>& scratch, F f) const {
+    const std::uint32_t trigrams = alphabet_ * alphabet_ * alphabet_;
+    scratch.clear();
+    for (const std::string* field : {&s.getName(), &s.getSurname()}) {
+        std::uint32_t code = symbol_[static_cast<unsigned char>(SEP)] - 1u;
+        for (std::size_t i = 0; i < field->size(); ++i) {
+            code = (code * alphabet_ + symbol_[static_cast<unsigned char>((*field)[i])] - 1u) % trigrams;
+            if (i >= 1) scratch.push_back(code);
+        }
+    }
+    std::sort(scratch.begin(), scratch.end());
+    scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+    for (std::uint32_t c : scratch) f(c);
+}
+
+NameSearch::NameSearch(const std::vector<Student>& students, unsigned threads)
+    : records_(students.data()), size_(students.size()) {
+    Trace::Span span("name search build", "index");
+    if (size_ > UINT32_MAX) throw FileException("Too many records for the search index");
+
+    // Alphabet: the separator plus every byte used in a name
+    bool seen[256] = {};
+    seen[static_cast<unsigned char>(SEP)] = true;
+    for (const auto& s : students) {
+        for (unsigned char c : s.getName()) seen[c] = true;
+        for (unsigned char c : s.getSurname()) seen[c] = true;
+    }
+    for (int c = 0; c < 256; ++c)
+        if (seen[c]) symbol_[c] = static_cast<std::uint8_t>(++alphabet_);
+    const std::size_t trigrams = static_cast<std::size_t>(alphabet_) * alphabet_ * alphabet_;
+
+    // Pass 1 counts each part's postings per trigram; the prefix sum over
+    // (trigram, part) then gives every part its own write cursors, so pass 2
+    // writes without synchronization and the lists stay in record order.
+    const unsigned parts = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), size_ / PARALLEL_SLICE + 1));
+    std::vector<std::vector<std::uint32_t>> cursors(parts);
+    auto range = [&](unsigned k) { return std::make_pair(size_ * k / parts, size_ * (k + 1) / parts); };
+
+    Pipeline::runParts(parts, "index worker", [&](unsigned k) {
+        Trace::Span span("count trigrams", "index");
+        auto& count = cursors[k];
+        count.assign(trigrams, 0);
+        std::vector<std::uint32_t> scratch;
+        for (auto [i, end] = range(k); i < end; ++i)
+            forEachTrigram(students[i], scratch, [&](std::uint32_t c) { ++count[c]; });
+    });
+
+    offsets_.assign(trigrams + 1, 0);
+    std::uint64_t total = 0;
+    for (std::size_t c = 0; c < trigrams; ++c) {
+        offsets_[c] = static_cast<std::uint32_t>(total);
+        for (auto& cursor : cursors) {
+            const std::uint32_t n = cursor[c];
+            cursor[c] = static_cast<std::uint32_t>(total);
+            total += n;
+        }
+        if (total > UINT32_MAX) throw FileException("Too many postings for the search index");
+    }
+    offsets_[trigrams] = static_cast<std::uint32_t>(total);
+    postings_.resize(total);
+
+    Pipeline::runParts(parts, "index worker", [&](unsigned k) {
+        Trace::Span span("fill postings", "index");
+        auto& cursor = cursors[k];
+        std::vector<std::uint32_t> scratch;
+        for (auto [i, end] = range(k); i < end; ++i)
+            forEachTrigram(students[i], scratch, [&](std::uint32_t c) { postings_[cursor[c]++] = static_cast<std::uint32_t>(i); });
+    });
+}
+
+std::vector<std::uint32_t> NameSearch::find(std::string_view pattern, bool prefix, Field field) const {
+    const std::string needle = (prefix ? std::string(1, SEP) : std::string()) + std::string(pattern);
+    if (needle.size() < 3 || !searchable(pattern)) return scan(records_, size_, pattern, prefix, field);
+
+    // Posting lists of the needle's trigrams, shortest first
+    const std::uint32_t trigrams = alphabet_ * alphabet_ * alphabet_;
+    std::vector<std::pair<const std::uint32_t*, const std::uint32_t*>> lists;
+    std::uint32_t code = 0;
+    for (std::size_t i = 0; i < needle.size(); ++i) {
+        const std::uint32_t sym = symbol_[static_cast<unsigned char>(needle[i])];
+        if (sym == 0) return {}; // a byte no name contains
+        code = (code * alphabet_ + sym - 1u) % trigrams;
+        if (i >= 2) lists.emplace_back(postings_.data() + offsets_[code], postings_.data() + offsets_[code + 1]);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto& a, const auto& b) { return a.second - a.first < b.second - b.first; });
+
+    // Intersect, galloping through each longer list from the last hit
+    std::vector<std::uint32_t> out(lists[0].first, lists[0].second);
+    for (std::size_t l = 1; l < lists.size() && !out.empty(); ++l) {
+        const std::uint32_t* it = lists[l].first;
+        const std::uint32_t* end = lists[l].second;
+        std::size_t kept = 0;
+        for (std::uint32_t r : out) {
+            std::size_t step = 1;
+            while (it + step < end && it[step] < r) {
+                it += step;
+                step *= 2;
+            }
+            const std::uint32_t* hi = static_cast<std::size_t>(end - it) > step ? it + step + 1 : end;
+            it = std::lower_bound(it, hi, r);
+            if (it == end) break;
+            if (*it == r) out[kept++] = r;
+        }
+        out.resize(kept);
+    }
+
+    // Shared trigrams do not prove the pattern occurs, in order, in one field
+    out.erase(std::remove_if(out.begin(), out.end(),
+                             [&](std::uint32_t r) { return !recordMatches(records_[r], pattern, prefix, field); }),
+              out.end());
+    return out;
+}
+
+std::vector<std::uint32_t> NameSearch::findSubstring(std::string_view pattern, Field field) const {
+    return find(pattern, false, field);
+}
+
+std::vector<std::uint32_t> NameSearch::findPrefix(std::string_view prefix, Field field) const {
+    return find(prefix, true, field);
+}
+
+std::size_t NameSearch::memoryBytes() const {
+    return (offsets_.capacity() + postings_.capacity()) * sizeof(std::uint32_t) + sizeof symbol_;
+}
+
+std::vector<std::uint32_t> NameSearch::scanSubstring(const std::vector<Student>& students, std::string_view pattern,
+                                                     Field field) {
+    return scan(students.data(), students.size(), pattern, false, field);
+}
+
+std::vector<std::uint32_t> NameSearch::scanPrefix(const std::vector<Student>& students, std::string_view prefix,
+                                                  Field field) {
+    return scan(students.data(), students.size(), prefix, true, field);
+}
+
+NameSearch::Field searchFieldFromName(const std::string& name) {
+    if (name == "any") return NameSearch::Field::Any;
+    if (name == "name") return NameSearch::Field::Name;
+    if (name == "surname") return NameSearch::Field::Surname;
+    throw ParseException("Unknown search field: " + name + " (any, name, surname)");
+}
@@ -0,0 +1,141 @@
+#include "PerfCounters.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool HwCounters::any() const {
+    for (bool p : present) {
+        if (p) return true;
+    }
+    return false;
+}
+
+bool HwCounters::anyMultiplexed() const {
+    for (std::size_t c = 0; c < COUNT; ++c) {
+        if (present[c] && multiplexed[c]) return true;
+    }
+    return false;
+}
+
+const char* HwCounters::name(std::size_t c) {
+    static const char* const names[COUNT] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "page_faults"
+    };
+    return c < COUNT ? names[c] : "?";
+}
+
+namespace PerfCounters {
+
+static std::atomic<int> enabledState{-1}; // -1: not yet read from the environment
+
+bool enabled() {
+    int s = enabledState.load(std::memory_order_relaxed);
+    if (s < 0) {
+        const char* env = std::getenv("SGC_HW_COUNTERS");
+        s = (env && *env && std::strcmp(env, "0") != 0) ? 1 : 0;
+        enabledState.store(s, std::memory_order_relaxed);
+    }
+    return s == 1;
+}
+
+void setEnabled(bool on) {
+    enabledState.store(on ? 1 : 0, std::memory_order_relaxed);
+}
+
+#ifdef __linux__
+
+static int openCounter(std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // Try kernel+user first; perf_event_paranoid >= 2 only allows user space.
+    for (int excludeKernel = 0; excludeKernel <= 1; ++excludeKernel) {
+        attr.exclude_kernel = static_cast<std::uint64_t>(excludeKernel);
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0) return static_cast<int>(fd);
+    }
+    return -1;
+}
+
+static constexpr std::uint64_t cacheConfig(std::uint64_t cache) {
+    return cache
+         | (static_cast<std::uint64_t>(PERF_COUNT_HW_CACHE_OP_READ) << 8)
+         | (static_cast<std::uint64_t>(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+}
+
+CounterGroup::CounterGroup() {
+    fds_[HwCounters::Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[HwCounters::Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[HwCounters::L1dMisses] = openCounter(PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D));
+    fds_[HwCounters::LlcMisses] = openCounter(PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL));
+    fds_[HwCounters::BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds_[HwCounters::PageFaults] = openCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+}
+
+CounterGroup::~CounterGroup() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void CounterGroup::start() {
+    for (int fd : fds_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+HwCounters CounterGroup::stop() {
+    HwCounters out;
+    for (int fd : fds_) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (std::size_t c = 0; c < HwCounters::COUNT; ++c) {
+        std::uint64_t v[3] = {}; // value, time enabled, time running
+        if (fds_[c] < 0 || read(fds_[c], v, sizeof(v)) != static_cast<ssize_t>(sizeof(v))) continue;
+        if (v[2] == 0) {
+            if (v[1] > 0) continue; // enabled but never scheduled: nothing measured
+            v[2] = v[1] = 1;        // the stage took no time
+        }
+        out.present[c] = true;
+        out.multiplexed[c] = v[2] < v[1];
+        out.value[c] = out.multiplexed[c]
+                           ? static_cast<std::uint64_t>(static_cast<unsigned __int128>(v[0]) * v[1] / v[2])
+                           : v[0];
+    }
+    return out;
+}
+
+#else
+
+CounterGroup::CounterGroup() { fds_.fill(-1); }
+CounterGroup::~CounterGroup() = default;
+void CounterGroup::start() {}
+HwCounters CounterGroup::stop() { return HwCounters{}; }
+
+#endif
+
+bool CounterGroup::available() const {
+    for (int fd : fds_) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+} // namespace PerfCounters
@@ -0,0 +1,65 @@
+#include "Pipeline.h"
+
+#include <streambuf>
+
+namespace Pipeline {
+
+static const char* const STAGE_SPAN_NAMES[STAGE_COUNT] = {"read", "sort", "split", "write"};
+
+StageProbe::StageProbe(PerfResult& r, PerfStage stage) : r_(r), stage_(stage) {
+    if (MemoryTracker::enabled()) memory_.reset(new MemoryTracker::Scope());
+    if (PerfCounters::enabled()) {
+        counters_.reset(new PerfCounters::CounterGroup());
+        counters_->start();
+    }
+    start_ = Trace::now();
+}
+
+double StageProbe::stop() {
+    std::uint64_t end = Trace::now();
+    if (counters_) r_.hw[stage_] = counters_->stop();
+    if (memory_) r_.mem[stage_] = memory_->stop();
+    if (Trace::enabled()) Trace::record(STAGE_SPAN_NAMES[stage_], "stage", start_, end);
+    return Trace::toMs(end - start_);
+}
+
+// Read-only view of a memory range as an istream source.
+class MemoryBuf : public std::streambuf {
+public:
+    MemoryBuf(char* first, char* last) { setg(first, first, last); }
+};
+
+std::vector<std::vector<Student>> parseFileSlices(const std::string& filename, unsigned parts) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) throw FileException("Cannot open file: " + filename);
+
+    std::string text;
+    {
+        Trace::Span span("load file", "read");
+        in.seekg(0, std::ios::end);
+        text.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0, std::ios::beg);
+        in.read(&text[0], static_cast<std::streamsize>(text.size()));
+        if (!in) throw FileException("Read failed: " + filename);
+    }
+
+    std::vector<std::size_t> bounds(parts + 1, text.size());
+    bounds[0] = 0;
+    for (unsigned k = 1; k < parts; ++k) {
+        std::size_t at = std::max(bounds[k - 1], text.size() * k / parts);
+        std::size_t nl = text.find('\n', at);
+        bounds[k] = (nl == std::string::npos) ? text.size() : nl + 1;
+    }
+
+    std::vector<std::vector<Student>> slices(parts);
+    runParts(parts, "parse worker", [&](unsigned k) {
+        Trace::Span span("parse slice", "read");
+        MemoryBuf buf(&text[0] + bounds[k], &text[0] + bounds[k + 1]);
+        std::istream slice(&buf);
+        parseStream(slice, slices[k]);
+        computeCaches(slices[k]);
+    });
+    return slices;
+}
+
+} // namespace Pipeline
@@ -0,0 +1,428 @@
+#include "QueryServer.h"
+#include "Analyzer.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "Sorter.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace QueryServer {
+
+// -------------------- DATASET --------------------
+
+Dataset::Dataset(std::vector<Student> students) : students_(std::move(students)) {
+    Sorter::sortVectorDesc(students_, Analyzer::threads());
+    passed_ = static_cast<std::size_t>(std::partition_point(students_.begin(), students_.end(),
+                                                            Pipeline::isPassed) - students_.begin());
+
+    index_ = NameIndex(students_, Analyzer::threads());
+    search_ = NameSearch(students_, Analyzer::threads());
+}
+
+Dataset Dataset::load(const std::vector<std::string>& files) {
+    std::vector<Student> all;
+    for (const auto& f : files) {
+        auto part = Analyzer::readVectorFromFile(f);
+        if (all.empty()) all = std::move(part);
+        else std::move(part.begin(), part.end(), std::back_inserter(all));
+    }
+    if (all.size() > UINT32_MAX) throw FileException("Too many records for the query index");
+    return Dataset(std::move(all));
+}
+
+std::vector<const Student*> Dataset::lookup(const std::string& name, const std::string& surname) const {
+    std::vector<const Student*> out;
+    for (std::uint32_t i : index_.find(name, surname)) out.push_back(&students_[i]);
+    return out;
+}
+
+std::vector<std::vector<const Student*>> Dataset::lookupBatch(const std::vector<NameIndex::Key>& keys) const {
+    NameIndex::BatchResult r = index_.findBatch(keys);
+    std::vector<std::vector<const Student*>> out(keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k)
+        for (std::uint32_t j = r.offsets[k]; j < r.offsets[k + 1]; ++j) out[k].push_back(&students_[r.positions[j]]);
+    return out;
+}
+
+std::vector<const Student*> Dataset::search(const std::string& text, bool prefix, std::size_t limit) const {
+    auto hits = prefix ? search_.findPrefix(text) : search_.findSubstring(text);
+    std::vector<const Student*> out;
+    for (std::size_t i = 0; i < hits.size() && i < limit; ++i) out.push_back(&students_[hits[i]]);
+    return out;
+}
+
+double Dataset::percentile(double p) const {
+    if (students_.empty()) return 0.0;
+    const std::size_t n = students_.size();
+    // nearest rank in ascending order; students_ is descending
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+    rank = std::clamp<std::size_t>(rank, 1, n);
+    return students_[n - rank].finalAvgCached();
+}
+
+// Floyd's algorithm: k draws, no duplicates, no O(n) state.
+std::vector<const Student*> Dataset::sample(std::size_t k, std::mt19937_64& rng) const {
+    const std::size_t n = students_.size();
+    k = std::min(k, n);
+    std::unordered_set<std::size_t> chosen;
+    std::vector<const Student*> out;
+    out.reserve(k);
+    for (std::size_t j = n - k; j < n; ++j) {
+        std::size_t t = std::uniform_int_distribution<std::size_t>(0, j)(rng);
+        if (!chosen.insert(t).second) {
+            chosen.insert(j);
+            t = j;
+        }
+        out.push_back(&students_[t]);
+    }
+    return out;
+}
+
+// -------------------- PROTOCOL --------------------
+
+static void appendRows(std::string& out, const std::vector<const Student*>& rows) {
+    out += "ROWS " + std::to_string(rows.size()) + "\n";
+    char grade[32];
+    for (const Student* s : rows) {
+        std::snprintf(grade, sizeof grade, " %.2f\n", s->finalAvgCached());
+        out += s->getName();
+        out += ' ';
+        out += s->getSurname();
+        out += grade;
+    }
+}
+
+static bool parseRows(const std::string& token, std::size_t& k) {
+    char* end = nullptr;
+    unsigned long long v = std::strtoull(token.c_str(), &end, 10);
+    if (token.empty() || *end != '\0' || token[0] == '-' || v > MAX_ROWS) return false;
+    k = static_cast<std::size_t>(v);
+    return true;
+}
+
+static std::mt19937_64& threadRng() {
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    return rng;
+}
+
+bool handle(const Dataset& data, const std::string& line, std::string& out) {
+    std::istringstream in(line);
+    std::vector<std::string> args;
+    for (std::string t; in >> t;) args.push_back(std::move(t));
+    if (args.empty()) {
+        out += "ERR empty request\n";
+        return true;
+    }
+
+    const std::string& cmd = args[0];
+    const std::size_t argc = args.size() - 1;
+    std::size_t k = 0;
+
+    if (cmd == "GET" && argc == 2) {
+        appendRows(out, data.lookup(args[1], args[2]));
+    } else if (cmd == "MGET" && argc >= 2 && argc % 2 == 0) {
+        std::vector<NameIndex::Key> keys;
+        for (std::size_t i = 1; i < args.size(); i += 2) keys.push_back({args[i], args[i + 1]});
+        for (const auto& rows : data.lookupBatch(keys)) appendRows(out, rows);
+    } else if ((cmd == "FIND" || cmd == "PREFIX") && argc == 1) {
+        appendRows(out, data.search(args[1], cmd == "PREFIX", MAX_ROWS));
+    } else if (cmd == "TOP" && argc == 1 && parseRows(args[1], k)) {
+        k = std::min(k, data.size());
+        std::vector<const Student*> rows;
+        rows.reserve(k);
+        for (std::size_t i = 0; i < k; ++i) rows.push_back(&data.byRank(i));
+        appendRows(out, rows);
+    } else if (cmd == "SAMPLE" && argc == 1 && parseRows(args[1], k)) {
+        appendRows(out, data.sample(k, threadRng()));
+    } else if (cmd == "COUNT" && argc == 0) {
+        out += "OK " + std::to_string(data.size()) + " " + std::to_string(data.passed()) + " "
+             + std::to_string(data.size() - data.passed()) + "\n";
+    } else if (cmd == "PCT" && argc == 1) {
+        char* end = nullptr;
+        double p = std::strtod(args[1].c_str(), &end);
+        if (*end != '\0' || !(p > 0.0 && p <= 100.0)) {
+            out += "ERR percentile must be in (0, 100]\n";
+        } else {
+            char buf[48];
+            std::snprintf(buf, sizeof buf, "OK %.2f\n", data.percentile(p));
+            out += buf;
+        }
+    } else if (cmd == "PING" && argc == 0) {
+        out += "OK\n";
+    } else if (cmd == "QUIT" && argc == 0) {
+        out += "OK\n";
+        return false;
+    } else if (cmd == "FIND" || cmd == "PREFIX") {
+        out += "ERR usage: " + cmd + " <text>\n";
+    } else if (cmd == "MGET") {
+        out += "ERR usage: MGET <name> <surname> [<name> <surname> ...]\n";
+    } else if (cmd == "TOP" || cmd == "SAMPLE") {
+        out += "ERR usage: " + cmd + " <k>, k <= " + std::to_string(MAX_ROWS) + "\n";
+    } else {
+        out += "ERR unknown request: " + line + "\n";
+    }
+    return true;
+}
+
+// -------------------- SERVER --------------------
+// Every worker polls the shared listening socket plus its own connections;
+// whichever worker wins accept() owns the new client. The dataset is
+// read-only, so workers never synchronize with each other.
+
+static const std::size_t MAX_LINE = 4096;
+static const std::size_t MAX_PENDING_OUTPUT = 1 << 20; // stop reading a client until it drains
+static const int POLL_MS = 200;
+
+static std::atomic<bool> stopping{false};
+
+void stop() {
+    stopping.store(true);
+}
+
+extern "C" void onStopSignal(int) {
+    stopping.store(true);
+}
+
+struct Connection {
+    int fd = -1;
+    std::string in;
+    std::string out;
+    std::size_t sent = 0;
+    bool closing = false; // QUIT or protocol error: close once out is sent
+};
+
+static sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) throw FileException("Socket path too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+static int listenOn(const std::string& path) {
+    sockaddr_un addr = socketAddress(path);
+    struct stat st{};
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        // a socket left by a server that died is removed; a live one is not
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0) throw FileException("socket: " + std::string(std::strerror(errno)));
+        const bool live = connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0;
+        const bool stale = !live && errno == ECONNREFUSED;
+        close(probe);
+        if (live) throw FileException("A server is already listening on " + path);
+        if (stale) unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw FileException("socket: " + std::string(std::strerror(errno)));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::string err = std::strerror(errno);
+        close(fd);
+        throw FileException("Cannot listen on " + path + ": " + err);
+    }
+    return fd;
+}
+
+// Runs the complete request lines buffered in c.in until MAX_PENDING_OUTPUT
+// of answers is queued; the rest wait for the client to read.
+static void process(const Dataset& data, Connection& c, std::uint64_t& served) {
+    std::size_t start = 0;
+    for (std::size_t nl; !c.closing && c.out.size() < MAX_PENDING_OUTPUT
+                         && (nl = c.in.find('\n', start)) != std::string::npos;
+         start = nl + 1) {
+        std::string line = c.in.substr(start, nl - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        Trace::Span span("query", "server");
+        if (!handle(data, line, c.out)) c.closing = true;
+        ++served;
+    }
+    c.in.erase(0, start);
+    if (c.in.size() > MAX_LINE && c.in.find('\n') == std::string::npos) {
+        c.out += "ERR request line too long\n";
+        c.closing = true;
+    }
+}
+
+// Sends what it can; false on a dead peer.
+static bool flush(Connection& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += static_cast<std::size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+    c.out.clear();
+    c.sent = 0;
+    return true;
+}
+
+static std::uint64_t workerLoop(const Dataset& data, int listenFd) {
+    Trace::setThreadName("query worker");
+    std::vector<Connection> conns;
+    std::vector<pollfd> fds;
+    std::uint64_t served = 0;
+    char buf[65536];
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        fds.assign(1, pollfd{listenFd, POLLIN, 0});
+        for (const auto& c : conns) {
+            short events = 0;
+            if (!c.closing && c.out.size() < MAX_PENDING_OUTPUT) events |= POLLIN;
+            if (!c.out.empty()) events |= POLLOUT;
+            fds.push_back(pollfd{c.fd, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), POLL_MS) <= 0) continue;
+
+        for (std::size_t i = 0; i < conns.size(); ++i) {
+            Connection& c = conns[i];
+            const short re = fds[i + 1].revents;
+            bool alive = true;
+            if (re & POLLIN) {
+                ssize_t n = recv(c.fd, buf, sizeof buf, 0);
+                if (n > 0) {
+                    c.in.append(buf, static_cast<std::size_t>(n));
+                    process(data, c, served);
+                } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    alive = false;
+                }
+            } else if (re & (POLLHUP | POLLERR | POLLNVAL)) {
+                alive = false;
+            }
+            // lines held back by a full output buffer run as it drains
+            for (;;) {
+                if (alive && !c.out.empty()) alive = flush(c);
+                if (!alive || c.closing || c.out.size() >= MAX_PENDING_OUTPUT
+                    || c.in.find('\n') == std::string::npos)
+                    break;
+                process(data, c, served);
+            }
+            if (alive && c.closing && c.out.empty()) alive = false;
+            if (!alive) {
+                close(c.fd);
+                c.fd = -1;
+            }
+        }
+        conns.erase(std::remove_if(conns.begin(), conns.end(), [](const Connection& c) { return c.fd < 0; }),
+                    conns.end());
+
+        if (fds[0].revents & POLLIN) {
+            for (;;) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) break; // EAGAIN: another worker took it
+                Connection c;
+                c.fd = fd;
+                conns.push_back(std::move(c));
+            }
+        }
+    }
+
+    for (auto& c : conns) close(c.fd);
+    return served;
+}
+
+void serve(const Dataset& data, const ServerConfig& cfg) {
+    const unsigned workers = cfg.workers ? cfg.workers : std::max(1u, std::thread::hardware_concurrency());
+    const int listenFd = listenOn(cfg.socketPath);
+
+    stopping.store(false);
+    auto oldInt = std::signal(SIGINT, onStopSignal);
+    auto oldTerm = std::signal(SIGTERM, onStopSignal);
+
+    std::cerr << "Serving " << data.size() << " students on " << cfg.socketPath << " with " << workers
+              << " worker" << (workers == 1 ? "" : "s") << " (Ctrl-C to stop)\n";
+
+    std::vector<std::uint64_t> served(workers, 0);
+    Pipeline::runParts(workers, "query worker", [&](unsigned k) { served[k] = workerLoop(data, listenFd); });
+
+    std::signal(SIGINT, oldInt);
+    std::signal(SIGTERM, oldTerm);
+    close(listenFd);
+    unlink(cfg.socketPath.c_str());
+    std::cerr << "Stopped after " << std::accumulate(served.begin(), served.end(), std::uint64_t{0})
+              << " requests\n";
+}
+
+// -------------------- CLIENT --------------------
+
+Client::Client(const std::string& socketPath) {
+    sockaddr_un addr = socketAddress(socketPath);
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) throw FileException("socket: " + std::string(std::strerror(errno)));
+    if (connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        std::string err = std::strerror(errno);
+        close(fd_);
+        fd_ = -1;
+        throw FileException("Cannot connect to " + socketPath + ": " + err);
+    }
+}
+
+Client::~Client() {
+    if (fd_ >= 0) close(fd_);
+}
+
+std::string Client::readLine() {
+    char buf[65536];
+    std::size_t nl;
+    while ((nl = buffer_.find('\n')) == std::string::npos) {
+        ssize_t n = recv(fd_, buf, sizeof buf, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw FileException("Connection closed by server");
+        buffer_.append(buf, static_cast<std::size_t>(n));
+    }
+    std::string line = buffer_.substr(0, nl + 1);
+    buffer_.erase(0, nl + 1);
+    return line;
+}
+
+std::string Client::request(const std::string& line) {
+    std::string msg = line + "\n";
+    for (std::size_t off = 0; off < msg.size();) {
+        ssize_t n = send(fd_, msg.data() + off, msg.size() - off, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw FileException("Send failed: " + std::string(std::strerror(errno)));
+        off += static_cast<std::size_t>(n);
+    }
+
+    // MGET answers one ROWS block per name pair; anything else one response
+    std::size_t blocks = 1;
+    std::istringstream in(line);
+    std::string cmd;
+    if (in >> cmd && cmd == "MGET") {
+        std::size_t words = 0;
+        for (std::string t; in >> t;) ++words;
+        if (words >= 2 && words % 2 == 0) blocks = words / 2;
+    }
+
+    std::string response;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        std::string head = readLine();
+        response += head;
+        if (head.rfind("ROWS ", 0) != 0) break; // ERR ends the response
+        std::size_t rows = std::stoull(head.substr(5));
+        for (std::size_t i = 0; i < rows; ++i) response += readLine();
+    }
+    return response;
+}
+
+} // namespace QueryServer
@@ -0,0 +1,200 @@
+#include "RandomStudent.h"
+#include "ExceptionHandlers.h"
+#include "Pipeline.h"
+#include "RecordScanner.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace RandomStudent {
+
+// Whether parseLine would accept the line: a name and a surname
+static bool isRecord(std::string_view line) {
+    auto space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r'; };
+    std::size_t i = 0;
+    while (i < line.size() && space(line[i])) ++i;
+    while (i < line.size() && !space(line[i])) ++i;
+    while (i < line.size() && space(line[i])) ++i;
+    return i < line.size();
+}
+
+static Student toStudent(const RecordScanner::Record& r) {
+    return Student(std::string(r.name), std::string(r.surname), r.homework, r.exam);
+}
+
+// -------------------- RESERVOIR --------------------
+
+// in (0, 1): log() of it stays finite
+static double unitOpen(std::mt19937_64& rng) {
+    return std::uniform_real_distribution<double>(std::numeric_limits<double>::min(), 1.0)(rng);
+}
+
+std::vector<Student> reservoir(const std::vector<std::string>& files, std::size_t k, std::mt19937_64& rng) {
+    Trace::Span span("reservoir sample", "random");
+    std::vector<Student> out;
+    if (k == 0) return out;
+    out.reserve(k);
+
+    // Algorithm L: after the reservoir fills, the gap to the next record that
+    // replaces a random slot is geometric with a shrinking parameter w.
+    double w = std::exp(std::log(unitOpen(rng)) / static_cast<double>(k));
+    auto gap = [&]() -> std::uint64_t {
+        const double g = std::floor(std::log(unitOpen(rng)) / std::log1p(-w));
+        return g < 9e18 ? static_cast<std::uint64_t>(g) : std::numeric_limits<std::uint64_t>::max() / 2;
+    };
+    std::uint64_t seen = 0;
+    std::uint64_t next = k + gap(); // index of the next record to take once full
+    RecordScanner::Record r;
+    for (const auto& file : files) {
+        RecordScanner::forEachLine(file, 0, std::numeric_limits<std::uint64_t>::max(), [&](std::string_view line) {
+            if (!isRecord(line)) return;
+            const std::uint64_t i = seen++;
+            if (i < k) {
+                RecordScanner::parseLine(line, r);
+                out.push_back(toStudent(r));
+            } else if (i == next) {
+                RecordScanner::parseLine(line, r);
+                out[std::uniform_int_distribution<std::size_t>(0, k - 1)(rng)] = toStudent(r);
+                w *= std::exp(std::log(unitOpen(rng)) / static_cast<double>(k));
+                next = i + 1 + gap();
+            }
+        });
+    }
+    std::shuffle(out.begin(), out.end(), rng);
+    return out;
+}
+
+// -------------------- LINE INDEX --------------------
+
+// <file>.idx: magic, the file's size and mtime, the record count, then one
+// native-endian uint64 offset per record.
+static const char INDEX_MAGIC[8] = {'S', 'G', 'C', 'I', 'D', 'X', '1', '\n'};
+
+struct IndexHeader {
+    char magic[8];
+    std::uint64_t fileSize;
+    std::int64_t mtime;
+    std::uint64_t count;
+};
+
+LineIndex::LineIndex(const std::string& file, unsigned threads) : file_(file) {
+    std::error_code ec;
+    const auto fileSize = static_cast<std::uint64_t>(fs::file_size(file, ec));
+    if (ec) throw FileException("Cannot open file: " + file);
+    const auto mtime = static_cast<std::int64_t>(fs::last_write_time(file).time_since_epoch().count());
+
+    data_.open(file, std::ios::binary);
+    if (!data_.is_open()) throw FileException("Cannot open file: " + file);
+
+    const std::string path = pathFor(file);
+    idx_.open(path, std::ios::binary);
+    IndexHeader h{};
+    const bool fresh = idx_.is_open() && idx_.read(reinterpret_cast<char*>(&h), sizeof h)
+                       && std::memcmp(h.magic, INDEX_MAGIC, sizeof h.magic) == 0 && h.fileSize == fileSize
+                       && h.mtime == mtime && fs::file_size(path, ec) == sizeof h + h.count * sizeof(std::uint64_t);
+    if (fresh) {
+        count_ = h.count;
+        return;
+    }
+    idx_.close();
+    build(threads, fileSize, mtime);
+}
+
+void LineIndex::build(unsigned threads, std::uint64_t fileSize, std::int64_t mtime) {
+    Trace::Span span("line index build", "random");
+    built_ = true;
+    const unsigned parts = std::max(threads, 1u);
+    const auto bounds = RecordScanner::lineBounds(file_, parts);
+    std::vector<std::vector<std::uint64_t>> partial(parts);
+    Pipeline::runParts(parts, "line index worker", [&](unsigned p) {
+        RecordScanner::forEachLineAt(file_, bounds[p], bounds[p + 1], [&](std::uint64_t at, std::string_view line) {
+            if (isRecord(line)) partial[p].push_back(at);
+        });
+    });
+    for (auto& part : partial) {
+        offsets_.insert(offsets_.end(), part.begin(), part.end());
+        std::vector<std::uint64_t>().swap(part);
+    }
+    count_ = offsets_.size();
+
+    // written aside and renamed, so a reader never sees half an index
+    const std::string path = pathFor(file_);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        IndexHeader h{};
+        std::memcpy(h.magic, INDEX_MAGIC, sizeof h.magic);
+        h.fileSize = fileSize;
+        h.mtime = mtime;
+        h.count = count_;
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        out.write(reinterpret_cast<const char*>(offsets_.data()),
+                  static_cast<std::streamsize>(offsets_.size() * sizeof(std::uint64_t)));
+        if (!out) return; // read-only folder: keep the offsets
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+    idx_.open(path, std::ios::binary);
+    if (idx_.is_open()) std::vector<std::uint64_t>().swap(offsets_);
+}
+
+std::uint64_t LineIndex::offset(std::uint64_t i) const {
+    if (!offsets_.empty()) return offsets_[i];
+    std::uint64_t at = 0;
+    idx_.clear();
+    idx_.seekg(static_cast<std::streamoff>(sizeof(IndexHeader) + i * sizeof at));
+    if (!idx_.read(reinterpret_cast<char*>(&at), sizeof at))
+        throw FileException("Cannot read index: " + pathFor(file_));
+    return at;
+}
+
+Student LineIndex::at(std::uint64_t i) const {
+    data_.clear();
+    data_.seekg(static_cast<std::streamoff>(offset(i)));
+    std::string line;
+    std::getline(data_, line);
+    RecordScanner::Record r;
+    if (!RecordScanner::parseLine(line, r)) throw FileException("Stale index, no record at line offset: " + file_);
+    return toStudent(r);
+}
+
+// -------------------- INDEXED --------------------
+
+std::vector<Student> indexed(const std::vector<LineIndex>& indexes, std::size_t k, std::mt19937_64& rng) {
+    Trace::Span span("indexed sample", "random");
+    std::vector<std::uint64_t> ends; // cumulative record counts
+    std::uint64_t total = 0;
+    for (const auto& ix : indexes) ends.push_back(total += ix.size());
+    k = static_cast<std::size_t>(std::min<std::uint64_t>(k, total));
+
+    // Floyd: a uniform k-subset of [0, total) in k draws
+    std::unordered_set<std::uint64_t> picked;
+    std::vector<std::uint64_t> order;
+    for (std::uint64_t j = total - k; j < total; ++j) {
+        std::uint64_t t = std::uniform_int_distribution<std::uint64_t>(0, j)(rng);
+        if (!picked.insert(t).second) picked.insert(t = j);
+        order.push_back(t);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<Student> out;
+    out.reserve(k);
+    for (std::uint64_t g : order) {
+        const auto f = static_cast<std::size_t>(std::upper_bound(ends.begin(), ends.end(), g) - ends.begin());
+        out.push_back(indexes[f].at(g - (f ? ends[f - 1] : 0)));
+    }
+    return out;
+}
+
+} // namespace RandomStudent
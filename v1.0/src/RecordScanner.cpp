@@ -0,0 +1,136 @@
+#include "RecordScanner.h"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace RecordScanner {
+
+// -------------------- PARSE --------------------
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static void skipSpace(std::string_view s, std::size_t& i) {
+    while (i < s.size() && isSpace(s[i])) ++i;
+}
+
+static std::string_view word(std::string_view s, std::size_t& i) {
+    skipSpace(s, i);
+    const std::size_t from = i;
+    while (i < s.size() && !isSpace(s[i])) ++i;
+    return s.substr(from, i - from);
+}
+
+// operator>>(int&): optional sign, then decimal digits; fails without a digit
+// or when the value does not fit.
+static bool integer(std::string_view s, std::size_t& i, int& value) {
+    skipSpace(s, i);
+    std::size_t j = i;
+    bool negative = false;
+    if (j < s.size() && (s[j] == '+' || s[j] == '-')) negative = s[j++] == '-';
+    if (j == s.size() || s[j] < '0' || s[j] > '9') return false;
+
+    long long v = 0;
+    for (; j < s.size() && s[j] >= '0' && s[j] <= '9'; ++j) {
+        v = v * 10 + (s[j] - '0');
+        if (v > static_cast<long long>(INT_MAX) + 1) return false;
+    }
+    if (negative) v = -v;
+    if (v > INT_MAX || v < INT_MIN) return false;
+    value = static_cast<int>(v);
+    i = j;
+    return true;
+}
+
+bool parseLine(std::string_view line, Record& r) {
+    r.homework.clear();
+    r.exam = 0;
+    if (line.empty()) return false;
+
+    std::size_t i = 0;
+    r.name = word(line, i);
+    r.surname = word(line, i);
+    if (r.name.empty() || r.surname.empty()) return false;
+
+    for (int x; integer(line, i, x);) r.homework.push_back(x);
+    if (!r.homework.empty()) {
+        r.exam = r.homework.back();
+        r.homework.pop_back();
+    }
+    return true;
+}
+
+long long Record::homeworkSum() const {
+    long long sum = 0;
+    for (int h : homework) sum += h;
+    return sum;
+}
+
+double Record::finalAvg() const {
+    double avg = 0.0;
+    if (!homework.empty()) {
+        double sum = 0.0;
+        for (int h : homework) sum += h;
+        avg = sum / static_cast<double>(homework.size());
+    }
+    return 0.4 * avg + 0.6 * static_cast<double>(exam);
+}
+
+// -------------------- SPLIT --------------------
+
+std::vector<std::uint64_t> lineBounds(const std::string& path, unsigned parts) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) throw FileException("Cannot open file: " + path);
+    in.seekg(0, std::ios::end);
+    const auto size = static_cast<std::uint64_t>(in.tellg());
+
+    parts = std::max(parts, 1u);
+    std::vector<std::uint64_t> bounds(parts + 1, size);
+    bounds[0] = 0;
+    char buf[4096];
+    for (unsigned k = 1; k < parts; ++k) {
+        // the first line start at or after the even cut
+        std::uint64_t at = std::max(bounds[k - 1], size * k / parts);
+        if (at == 0 || at >= size) {
+            bounds[k] = at;
+            continue;
+        }
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(at - 1));
+        bounds[k] = size;
+        for (std::uint64_t off = at - 1; in.read(buf, sizeof buf) || in.gcount() > 0; off += sizeof buf) {
+            const char* nl = std::find(buf, buf + in.gcount(), '\n');
+            if (nl != buf + in.gcount()) {
+                bounds[k] = off + static_cast<std::uint64_t>(nl - buf) + 1;
+                break;
+            }
+        }
+    }
+    return bounds;
+}
+
+// -------------------- FOLDERS --------------------
+
+static bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<std::string> folderFiles(const std::string& folder) {
+    std::error_code ec;
+    if (!fs::is_directory(folder, ec)) throw FileException("Folder does not exist: " + folder);
+    std::vector<std::string> files;
+    for (const auto& e : fs::directory_iterator(folder)) {
+        if (!e.is_regular_file() || e.path().extension() != ".txt") continue;
+        std::string p = e.path().string();
+        if (endsWith(p, ".passed.txt") || endsWith(p, ".failed.txt")) continue;
+        files.push_back(std::move(p));
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+} // namespace RecordScanner
@@ -0,0 +1,228 @@
+#include "Shard.h"
+#include "ExceptionHandlers.h"
+#include "ExternalSort.h"
+#include "Pipeline.h"
+#include "RecordScanner.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Shard {
+
+// -------------------- TASKS --------------------
+
+std::vector<Task> plan(const std::string& input, unsigned shards, const std::string& workDir,
+                       Sorter::SortOrder order) {
+    const auto bounds = RecordScanner::lineBounds(input, std::max(shards, 1u));
+    std::vector<Task> tasks;
+    for (std::size_t k = 0; k + 1 < bounds.size(); ++k) {
+        if (bounds[k] == bounds[k + 1]) continue;
+        const fs::path base = fs::path(workDir) / ("shard-" + std::to_string(tasks.size()));
+        tasks.push_back({input, bounds[k], bounds[k + 1], base.string() + ".passed.txt", base.string() + ".failed.txt",
+                         order});
+    }
+    return tasks;
+}
+
+std::vector<std::string> taskArgs(const Task& t) {
+    return {"--input", t.input, "--range", std::to_string(t.begin), std::to_string(t.end),
+            "--passed", t.outPass, "--failed", t.outFail, "--order", Sorter::orderName(t.order)};
+}
+
+static std::uint64_t offsetFromText(const std::string& text) {
+    std::size_t used = 0;
+    unsigned long long v = 0;
+    try {
+        v = std::stoull(text, &used);
+    } catch (...) {
+        throw ParseException("Invalid byte offset: " + text);
+    }
+    if (used != text.size()) throw ParseException("Invalid byte offset: " + text);
+    return v;
+}
+
+Task taskFromArgs(const std::vector<std::string>& args) {
+    Task t;
+    bool ranged = false;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& a = args[i];
+        const std::size_t values = a == "--range" ? 2 : 1;
+        if (i + values >= args.size()) throw ParseException("Missing value for " + a);
+        if (a == "--input") t.input = args[++i];
+        else if (a == "--passed") t.outPass = args[++i];
+        else if (a == "--failed") t.outFail = args[++i];
+        else if (a == "--order") t.order = Sorter::orderFromName(args[++i]);
+        else if (a == "--range") {
+            t.begin = offsetFromText(args[++i]);
+            t.end = offsetFromText(args[++i]);
+            ranged = true;
+        } else throw ParseException("Unknown option: " + a);
+    }
+    if (t.input.empty() || !ranged || t.outPass.empty() || t.outFail.empty())
+        throw ParseException("A shard task needs --input, --range, --passed and --failed");
+    if (t.begin > t.end) throw ParseException("Empty shard range");
+    return t;
+}
+
+// -------------------- WORKER --------------------
+
+PerfResult runTask(const Task& t) {
+    Sorter::setOrder(t.order);
+    auto load = [&]() {
+        std::vector<Student> students;
+        RecordScanner::forEachRecord(t.input, t.begin, t.end, [&](const RecordScanner::Record& r) {
+            students.emplace_back(std::string(r.name), std::string(r.surname), r.homework, r.exam);
+        });
+        return students;
+    };
+    return Pipeline::run<std::vector<Student>>(load, t.outPass, t.outFail, SplitStrategy::Strategy2_MoveFailAndShrinkBase,
+                                               PartitionMode::StablePartition, "shard worker");
+}
+
+std::string resultLine(const PerfResult& r) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4) << r.total_students << " " << r.read_ms << " " << r.sort_ms << " "
+        << r.split_ms << " " << r.write_ms << " " << r.total_ms;
+    return out.str();
+}
+
+PerfResult resultFromLine(const std::string& line) {
+    std::istringstream in(line);
+    PerfResult r;
+    if (!(in >> r.total_students >> r.read_ms >> r.sort_ms >> r.split_ms >> r.write_ms >> r.total_ms))
+        throw ParseException("Unexpected shard worker output: " + line);
+    return r;
+}
+
+// -------------------- LOCAL LAUNCH --------------------
+
+struct Worker {
+    pid_t pid = -1;
+    int out = -1; // read end of the worker's stdout
+};
+
+// This executable as "shard-worker <task args>", stdout to a pipe; stderr
+// passes through.
+static Worker spawn(const Task& t) {
+    static const char* const SELF = "/proc/self/exe";
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) throw FileException("pipe failed for a shard worker");
+
+    std::vector<std::string> args = taskArgs(t);
+    args.insert(args.begin(), "shard-worker");
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(SELF));
+    for (auto& a : args) argv.push_back(a.data());
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw FileException("fork failed for a shard worker");
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        execv(SELF, argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+    return {pid, fds[0]};
+}
+
+// Reads the worker's stdout to the end and reaps it. Returns its exit status.
+static int finish(Worker& w, std::string& out) {
+    out.clear();
+    char buf[4096];
+    for (;;) {
+        ssize_t n = read(w.out, buf, sizeof buf);
+        if (n > 0) out.append(buf, static_cast<std::size_t>(n));
+        else if (n == 0 || errno != EINTR) break;
+    }
+    close(w.out);
+
+    int status = 0;
+    while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {}
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Every task at once, one process each. A worker's output is a single short
+// line, so collecting them in order never stalls a later worker.
+static std::vector<PerfResult> runLocal(const std::vector<Task>& tasks) {
+    std::vector<Worker> workers;
+    try {
+        for (const auto& t : tasks) workers.push_back(spawn(t));
+    } catch (...) {
+        std::string ignored;
+        for (auto& w : workers) {
+            kill(w.pid, SIGTERM);
+            finish(w, ignored);
+        }
+        throw;
+    }
+
+    std::vector<PerfResult> results;
+    std::string failed;
+    std::string out;
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+        const int status = finish(workers[i], out);
+        if (status != 0) {
+            failed += (failed.empty() ? "" : ", ") + std::to_string(i);
+            continue;
+        }
+        try {
+            results.push_back(resultFromLine(out));
+        } catch (const ParseException&) {
+            failed += (failed.empty() ? "" : ", ") + std::to_string(i);
+        }
+    }
+    if (!failed.empty()) throw FileException("Shard workers failed: " + failed);
+    return results;
+}
+
+// -------------------- COORDINATOR --------------------
+
+Result run(const std::string& input, const std::string& outPass, const std::string& outFail, const Config& cfg) {
+    Trace::Span span("sharded run", "shard");
+    Result res;
+    const unsigned workers =
+        std::clamp(cfg.workers ? cfg.workers : std::thread::hardware_concurrency(), 1u, MAX_WORKERS);
+    ExternalSort::TempDir work(cfg.workDir, "sgc-shard");
+
+    Trace::Span planSpan("plan shards", "shard");
+    const auto tasks = plan(input, workers, work.path(), Sorter::order());
+    res.planMs = planSpan.stop();
+
+    Trace::Span workSpan("shard workers", "shard");
+    res.shards = runLocal(tasks);
+    res.workMs = workSpan.stop();
+
+    // shards are in input order and the merge gives ties to the earlier
+    // file, so a total-order run writes what a single process would
+    Trace::Span mergeSpan("merge shards", "shard");
+    std::vector<std::string> passes, fails;
+    for (const auto& t : tasks) {
+        passes.push_back(t.outPass);
+        fails.push_back(t.outFail);
+    }
+    res.passed = ExternalSort::mergeSortedFiles(passes, outPass);
+    res.records = res.passed + ExternalSort::mergeSortedFiles(fails, outFail);
+    res.mergeMs = mergeSpan.stop();
+
+    res.totalMs = span.stop();
+    return res;
+}
+
+} // namespace Shard
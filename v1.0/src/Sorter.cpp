@@ -1,24 +1,117 @@
 #include "Sorter.h"
-#include <algorithm>
+#include "ExceptionHandlers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
 
 namespace Sorter {
 
-void sortVectorDesc(std::vector<Student>& v) {
-    std::sort(v.begin(), v.end(), [](const Student& a, const Student& b) {
-        return a.finalAvgCached() > b.finalAvgCached();
-    });
+template void sortRangeDesc(std::vector<Student>::iterator, std::vector<Student>::iterator, unsigned);
+template void sortRangeDesc(std::deque<Student>::iterator, std::deque<Student>::iterator, unsigned);
+template void sortRangeTotal(std::vector<Student>::iterator, std::vector<Student>::iterator, unsigned);
+template void sortRangeTotal(std::deque<Student>::iterator, std::deque<Student>::iterator, unsigned);
+
+void sortVectorDesc(std::vector<Student>& v, unsigned threads) {
+    Trace::Span span("Sorter::sortVectorDesc", "sort");
+    sortRangeDesc(v.begin(), v.end(), threads);
 }
 
-void sortDequeDesc(std::deque<Student>& d) {
-    std::sort(d.begin(), d.end(), [](const Student& a, const Student& b) {
-        return a.finalAvgCached() > b.finalAvgCached();
-    });
+void sortDequeDesc(std::deque<Student>& d, unsigned threads) {
+    Trace::Span span("Sorter::sortDequeDesc", "sort");
+    sortRangeDesc(d.begin(), d.end(), threads);
 }
 
 void sortListDesc(std::list<Student>& l) {
-    l.sort([](const Student& a, const Student& b) {
-        return a.finalAvgCached() > b.finalAvgCached();
-    });
+    Trace::Span span("Sorter::sortListDesc", "sort");
+    l.sort(ByGradeDesc());
+}
+
+// -------------------- ORDER SETTING --------------------
+
+static std::atomic<int> orderSetting{-1}; // -1: not yet read from the environment
+
+SortOrder order() {
+    int o = orderSetting.load(std::memory_order_relaxed);
+    if (o < 0) {
+        const char* env = std::getenv("SGC_ORDER");
+        o = static_cast<int>(SortOrder::Grade);
+        if (env && *env) {
+            try { o = static_cast<int>(orderFromName(env)); } catch (...) {}
+        }
+        orderSetting.store(o, std::memory_order_relaxed);
+    }
+    return static_cast<SortOrder>(o);
+}
+
+void setOrder(SortOrder o) {
+    orderSetting.store(static_cast<int>(o), std::memory_order_relaxed);
+}
+
+SortOrder orderFromName(const std::string& name) {
+    if (name == "grade") return SortOrder::Grade;
+    if (name == "total") return SortOrder::Total;
+    throw ParseException("Unknown sort order: " + name + " (grade, total)");
 }
 
+const char* orderName(SortOrder o) {
+    return o == SortOrder::Total ? "total" : "grade";
 }
+
+// -------------------- PACKED KEYS --------------------
+
+// Unsigned integers ordered as the doubles are (no NaNs; -0.0 counts as 0.0)
+static std::uint64_t orderedBits(double d) {
+    if (d == 0.0) d = 0.0;
+    std::uint64_t u;
+    std::memcpy(&u, &d, sizeof u);
+    return (u >> 63) ? ~u : u | (1ull << 63);
+}
+
+static unsigned bitsFor(std::size_t values) {
+    unsigned bits = 0;
+    while (bits < 64 && (values - 1) >> bits) ++bits;
+    return bits;
+}
+
+std::vector<PackedKey> packKeys(const std::vector<const Student*>& records) {
+    Trace::Span span("pack sort keys", "sort");
+    std::vector<PackedKey> keys(records.size());
+    if (records.empty()) return keys;
+
+    // distinct grades, ranked best first
+    std::unordered_map<std::uint64_t, std::uint64_t> rank;
+    std::size_t shared = records[0]->getSurname().size();
+    for (const Student* r : records) {
+        rank.emplace(orderedBits(r->finalAvgCached()), 0);
+        const std::string& a = records[0]->getSurname();
+        const std::string& b = r->getSurname();
+        shared = std::min(shared, b.size());
+        while (shared > 0 && std::memcmp(a.data(), b.data(), shared) != 0) --shared;
+    }
+    std::vector<std::uint64_t> grades;
+    grades.reserve(rank.size());
+    for (const auto& [g, _] : rank) grades.push_back(g);
+    std::sort(grades.begin(), grades.end(), std::greater<>());
+    for (std::size_t i = 0; i < grades.size(); ++i) rank[grades[i]] = i;
+
+    const unsigned rankBits = bitsFor(grades.size());
+    const unsigned tailBits = 64 - rankBits;
+    const std::size_t bytes = tailBits / 8;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const std::string& surname = records[i]->getSurname();
+        std::uint64_t tail = 0;
+        for (std::size_t b = 0; b < bytes; ++b) {
+            const std::size_t at = shared + b;
+            tail = tail << 8 | (at < surname.size() ? static_cast<unsigned char>(surname[at]) : 0u);
+        }
+        std::uint64_t key = bytes ? tail << (tailBits - 8 * bytes) : 0;
+        if (rankBits) key |= rank[orderedBits(records[i]->finalAvgCached())] << tailBits;
+        keys[i] = {key, i};
+    }
+    return keys;
+}
+
+} // namespace Sorter
@@ -0,0 +1,276 @@
+#include "Trace.h"
+#include "ExceptionHandlers.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define SGC_HAVE_TSC 1
+#endif
+
+namespace Trace {
+
+static std::atomic<int> enabledState{-1}; // -1: not yet read from the environment
+
+bool enabled() {
+    int s = enabledState.load(std::memory_order_relaxed);
+    if (s < 0) {
+        const char* env = std::getenv("SGC_TRACE");
+        s = (env && *env && std::strcmp(env, "0") != 0) ? 1 : 0;
+        enabledState.store(s, std::memory_order_relaxed);
+    }
+    return s == 1;
+}
+
+void setEnabled(bool on) {
+    enabledState.store(on ? 1 : 0, std::memory_order_relaxed);
+}
+
+// -------------------- CLOCK --------------------
+
+static std::uint64_t steadyNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#ifdef SGC_HAVE_TSC
+// CPUID 0x80000007 EDX bit 8: the TSC ticks at a constant rate in every
+// P-/C-state, so it can stand in for wall time.
+static bool invariantTsc() {
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    if (!__get_cpuid(0x80000000u, &a, &b, &c, &d) || a < 0x80000007u) return false;
+    __get_cpuid(0x80000007u, &a, &b, &c, &d);
+    return (d & (1u << 8)) != 0;
+}
+static const bool useTsc = invariantTsc();
+#else
+static const bool useTsc = false;
+#endif
+
+std::uint64_t now() {
+#ifdef SGC_HAVE_TSC
+    if (useTsc) return __rdtsc();
+#endif
+    return steadyNs();
+}
+
+// Reference points taken at startup. The TSC rate is measured against
+// steady_clock right away, over a short spin, so no timed region ever pays
+// for calibration; the TSC is read on both sides of each steady_clock read.
+struct ClockPoint {
+    std::uint64_t ticks;
+    std::uint64_t ns;
+};
+
+static ClockPoint clockPoint() {
+    std::uint64_t before = now();
+    std::uint64_t ns = steadyNs();
+    std::uint64_t after = now();
+    return ClockPoint{before + (after - before) / 2, ns};
+}
+
+static const ClockPoint origin = clockPoint();
+static const std::uint64_t originTicks = origin.ticks;
+
+static double calibrate() {
+    if (!useTsc) return 1.0;
+    const std::uint64_t windowNs = 2'000'000;
+    while (steadyNs() - origin.ns < windowNs) {}
+    ClockPoint p = clockPoint();
+    return static_cast<double>(p.ns - origin.ns) / static_cast<double>(p.ticks - origin.ticks);
+}
+
+static const double nsPerTick = calibrate();
+
+double toMs(std::uint64_t ticks) {
+    return static_cast<double>(ticks) * nsPerTick / 1e6;
+}
+
+// -------------------- PER-THREAD BUFFERS --------------------
+// Each thread appends to its own list of fixed-size chunks and publishes the
+// new size with a release store; the exporter reads sizes with acquire loads,
+// so recording never waits on the exporter or on other threads. Buffers of
+// finished threads are handed to the next new thread (same trace row).
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+struct Chunk {
+    static constexpr std::size_t CAPACITY = 1024;
+    Event events[CAPACITY];
+    std::atomic<std::size_t> size{0};
+    std::atomic<Chunk*> next{nullptr};
+};
+
+struct ThreadBuffer {
+    std::uint32_t tid = 0;
+    std::atomic<const char*> name{nullptr};
+    std::atomic<bool> retired{false};
+    Chunk* head = new Chunk;
+    Chunk* tail = head; // touched by the owning thread (and clear())
+
+    ~ThreadBuffer() {
+        for (Chunk* c = head; c;) {
+            Chunk* next = c->next.load(std::memory_order_relaxed);
+            delete c;
+            c = next;
+        }
+    }
+};
+
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+static ThreadBuffer* acquireBuffer() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& b : registry) {
+        bool expected = true;
+        if (b->retired.compare_exchange_strong(expected, false)) {
+            b->name.store(nullptr, std::memory_order_relaxed);
+            return b.get();
+        }
+    }
+    registry.push_back(std::make_unique<ThreadBuffer>());
+    registry.back()->tid = static_cast<std::uint32_t>(registry.size());
+    return registry.back().get();
+}
+
+// The thread name is kept here as well, so a name set before tracing was
+// turned on still labels the buffer acquired by the first span.
+struct BufferHandle {
+    ThreadBuffer* buffer = nullptr;
+    const char* name = nullptr;
+    ~BufferHandle() {
+        if (buffer) buffer->retired.store(true, std::memory_order_release);
+    }
+};
+
+static thread_local BufferHandle handle;
+
+static ThreadBuffer& localBuffer() {
+    if (!handle.buffer) {
+        handle.buffer = acquireBuffer();
+        handle.buffer->name.store(handle.name, std::memory_order_relaxed);
+    }
+    return *handle.buffer;
+}
+
+void record(const char* name, const char* category, std::uint64_t begin, std::uint64_t end) {
+    ThreadBuffer& buf = localBuffer();
+    Chunk* c = buf.tail;
+    std::size_t n = c->size.load(std::memory_order_relaxed);
+    if (n == Chunk::CAPACITY) {
+        Chunk* fresh = new Chunk;
+        c->next.store(fresh, std::memory_order_release);
+        buf.tail = c = fresh;
+        n = 0;
+    }
+    c->events[n] = Event{name, category, begin, end};
+    c->size.store(n + 1, std::memory_order_release);
+}
+
+void setThreadName(const char* name) {
+    handle.name = name;
+    if (handle.buffer) handle.buffer->name.store(name, std::memory_order_relaxed);
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& b : registry) {
+        Chunk* c = b->head->next.exchange(nullptr, std::memory_order_relaxed);
+        while (c) {
+            Chunk* next = c->next.load(std::memory_order_relaxed);
+            delete c;
+            c = next;
+        }
+        b->head->size.store(0, std::memory_order_relaxed);
+        b->tail = b->head;
+    }
+}
+
+template <typename F>
+static void forEachEvent(const ThreadBuffer& b, F f) {
+    for (const Chunk* c = b.head; c; c = c->next.load(std::memory_order_acquire)) {
+        std::size_t n = c->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) f(c->events[i]);
+    }
+}
+
+std::size_t spanCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t total = 0;
+    for (const auto& b : registry) forEachEvent(*b, [&](const Event&) { ++total; });
+    return total;
+}
+
+// -------------------- CHROME TRACE EXPORT --------------------
+
+static void writeJsonString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        unsigned char ch = static_cast<unsigned char>(*s);
+        if (ch == '"' || ch == '\\') out << '\\' << *s;
+        else if (ch < 0x20) out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(ch)
+                                << std::dec << std::setfill(' ');
+        else out << *s;
+    }
+    out << '"';
+}
+
+// Timestamps are microseconds since startup.
+static double toUs(std::uint64_t ticks) {
+    return toMs(ticks - originTicks) * 1e3;
+}
+
+void writeChromeJson(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const long pid = static_cast<long>(getpid());
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for (const auto& b : registry) {
+        if (const char* name = b->name.load(std::memory_order_relaxed)) {
+            out << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+                << ", \"tid\": " << b->tid << ", \"args\": {\"name\": ";
+            writeJsonString(out, name);
+            out << "}}";
+            first = false;
+        }
+        forEachEvent(*b, [&](const Event& e) {
+            out << (first ? "\n" : ",\n") << "{\"name\": ";
+            writeJsonString(out, e.name);
+            out << ", \"cat\": ";
+            writeJsonString(out, e.category);
+            out << ", \"ph\": \"X\", \"ts\": " << toUs(e.begin) << ", \"dur\": " << toMs(e.end - e.begin) * 1e3
+                << ", \"pid\": " << pid << ", \"tid\": " << b->tid << "}";
+            first = false;
+        });
+    }
+    out << "\n]}\n";
+}
+
+void writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw FileException("Cannot open trace file: " + path);
+    writeChromeJson(out);
+    if (!out) throw FileException("Write failed: " + path);
+}
+
+} // namespace Trace
@@ -1,10 +1,28 @@
+#include "Aggregate.h"
 #include "Analyzer.h"
+#include "Benchmark.h"
+#include "CacheControl.h"
+#include "Compare.h"
 #include "FileGenerator.h"
+#include "GradeStats.h"
+#include "IncrementalDataset.h"
 #include "ExceptionHandlers.h"
+#include "ExternalSort.h"
+#include "NameSearch.h"
+#include "QueryServer.h"
+#include "RandomStudent.h"
+#include "RecordScanner.h"
+#include "Shard.h"
+#include "Trace.h"
 
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -14,19 +32,34 @@ static void printMenu() {
     std::cout << "1) Generate data files (default: 1k,10k,100k,1M,10M)\n";
     std::cout << "2) Run benchmark on ONE file (all containers, both strategies)\n";
     std::cout << "3) Run benchmark on ALL default sizes in folder (all containers, both strategies)\n";
-    std::cout << "4) Exit\n";
+    std::cout << "4) Run in-memory benchmark on synthetic records (no disk I/O)\n";
+    std::cout << "5) Grade statistics of files (exact histogram, percentiles, pass rate)\n";
+    std::cout << "6) Manual entry: edit a dataset, sorted order and pass/fail kept up to date\n";
+    std::cout << "7) Random students from a folder (reservoir sample or line-offset index)\n";
+    std::cout << "8) Highest/lowest final grade, count and pass/fail of a folder (one streaming pass)\n";
+    std::cout << "9) Exit\n";
     std::cout << "Choose: ";
 }
 
-static std::string strategyTag(SplitStrategy s) {
-    return (s == SplitStrategy::Strategy1_CopyToTwoContainers) ? "S1" : "S2";
-}
+using Analyzer::pmodeTag;
+using Analyzer::strategyTag;
+
+using CacheControl::CacheMode;
 
-static std::string pmodeTag(PartitionMode p) {
-    return (p == PartitionMode::StablePartition) ? "stable" : "partition";
+static CacheMode askCacheMode() {
+    std::cout << "Page cache before each run (asis, cold, warm) [asis]: ";
+    std::string line;
+    std::getline(std::cin, line);
+    if (line.empty()) return CacheMode::AsIs;
+    try {
+        return CacheControl::cacheModeFromName(line);
+    } catch (const std::exception& e) {
+        std::cout << e.what() << " (using asis)\n";
+        return CacheMode::AsIs;
+    }
 }
 
-static void runAllOnFile(const std::string& input, SplitStrategy strat, PartitionMode pmode) {
+static void runAllOnFile(const std::string& input, SplitStrategy strat, PartitionMode pmode, CacheMode cache) {
     std::string base = input + ".v1";
 
     std::string vPass = base + ".vector." + strategyTag(strat) + "." + pmodeTag(pmode) + ".passed.txt";
@@ -38,17 +71,36 @@ static void runAllOnFile(const std::string& input, SplitStrategy strat, Partitio
     std::string lPass = base + ".list." + strategyTag(strat) + "." + pmodeTag(pmode) + ".passed.txt";
     std::string lFail = base + ".list." + strategyTag(strat) + "." + pmodeTag(pmode) + ".failed.txt";
 
-    std::cout << "\n--- Strategy " << strategyTag(strat) << " (" << pmodeTag(pmode) << ") for: " << input << " ---\n";
+    std::string sPass = base + ".segmented." + strategyTag(strat) + "." + pmodeTag(pmode) + ".passed.txt";
+    std::string sFail = base + ".segmented." + strategyTag(strat) + "." + pmodeTag(pmode) + ".failed.txt";
+
+    std::string pPass = base + ".pooled-list." + strategyTag(strat) + "." + pmodeTag(pmode) + ".passed.txt";
+    std::string pFail = base + ".pooled-list." + strategyTag(strat) + "." + pmodeTag(pmode) + ".failed.txt";
+
+    std::cout << "\n--- Strategy " << strategyTag(strat) << " (" << pmodeTag(pmode) << ", "
+              << CacheControl::cacheModeName(cache) << " cache) for: " << input << " ---\n";
 
+    // every container starts from the same page-cache state
+    CacheControl::prepare(input, cache);
     auto rv = Analyzer::runVectorPipeline(input, vPass, vFail, strat, pmode);
     Analyzer::printPerf("Vector:", rv);
 
+    CacheControl::prepare(input, cache);
     auto rd = Analyzer::runDequePipeline(input, dPass, dFail, strat, pmode);
     Analyzer::printPerf("Deque: ", rd);
 
+    CacheControl::prepare(input, cache);
     auto rl = Analyzer::runListPipeline(input, lPass, lFail, strat, pmode);
     Analyzer::printPerf("List:  ", rl);
 
+    CacheControl::prepare(input, cache);
+    auto rs = Analyzer::runSegmentedPipeline(input, sPass, sFail, strat, pmode);
+    Analyzer::printPerf("SegVec:", rs);
+
+    CacheControl::prepare(input, cache);
+    auto rp = Analyzer::runPooledListPipeline(input, pPass, pFail, strat, pmode);
+    Analyzer::printPerf("PoolLs:", rp);
+
     std::cout << "Output files created next to input file.\n";
 }
 
@@ -57,8 +109,28 @@ static void optionGenerate() {
         std::string folder = "data/generated";
         fs::create_directories(folder);
 
+        FileGenerator::GeneratorOptions opts;
+        std::cout << "Seed (default " << FileGenerator::DEFAULT_SEED << "): ";
+        std::string line;
+        std::getline(std::cin, line);
+        if (!line.empty()) {
+            try { opts.seed = std::stoull(line); } catch (...) { opts.seed = FileGenerator::DEFAULT_SEED; }
+        }
+
+        std::cout << "Threads (default: all cores): ";
+        std::getline(std::cin, line);
+        if (!line.empty()) {
+            try { opts.threads = static_cast<unsigned>(std::stoul(line)); } catch (...) { opts.threads = 0; }
+        }
+
+        std::cout << "Workload profile (";
+        for (auto p : FileGenerator::allProfiles()) std::cout << " " << FileGenerator::profileName(p);
+        std::cout << " ) [uniform]: ";
+        std::getline(std::cin, line);
+        if (!line.empty()) opts.profile = FileGenerator::profileFromName(line);
+
         std::vector<std::uint64_t> counts = {1000, 10000, 100000, 1000000, 10000000};
-        FileGenerator::generateFilesForCounts(folder, counts, 5);
+        FileGenerator::generateFilesForCounts(folder, counts, opts);
     } catch (const std::exception& e) {
         std::cerr << "Generate error: " << e.what() << "\n";
     }
@@ -74,11 +146,12 @@ static void optionRunOne() {
         std::cout << "File does not exist: " << input << "\n";
         return;
     }
+    CacheMode cache = askCacheMode();
 
     // run both strategies, both partition modes
-    runAllOnFile(input, SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition);
-    runAllOnFile(input, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition);
-    runAllOnFile(input, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::StablePartition);
+    runAllOnFile(input, SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition, cache);
+    runAllOnFile(input, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition, cache);
+    runAllOnFile(input, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::StablePartition, cache);
 }
 
 static void optionRunAll() {
@@ -86,6 +159,7 @@ static void optionRunAll() {
     std::string folder;
     std::getline(std::cin, folder);
     if (folder.empty()) folder = "data/generated";
+    CacheMode cache = askCacheMode();
 
     std::vector<std::uint64_t> counts = {1000, 10000, 100000, 1000000, 10000000};
 
@@ -96,13 +170,755 @@ static void optionRunAll() {
             continue;
         }
 
-        runAllOnFile(file, SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition);
-        runAllOnFile(file, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition);
-        runAllOnFile(file, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::StablePartition);
+        runAllOnFile(file, SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition, cache);
+        runAllOnFile(file, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition, cache);
+        runAllOnFile(file, SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::StablePartition, cache);
+    }
+}
+
+static void optionRunInMemory() {
+    std::cout << "Record count (default 1000000): ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::uint64_t count = 1000000;
+    if (!line.empty()) {
+        try { count = std::stoull(line); } catch (...) { count = 1000000; }
+    }
+
+    FileGenerator::GeneratorOptions opts;
+    std::cout << "Workload profile [uniform]: ";
+    std::getline(std::cin, line);
+    try {
+        if (!line.empty()) opts.profile = FileGenerator::profileFromName(line);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return;
+    }
+
+    const std::pair<SplitStrategy, PartitionMode> runs[] = {
+        {SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition},
+        {SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition},
+        {SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::StablePartition},
+    };
+
+    for (const auto& [strat, pmode] : runs) {
+        std::cout << "\n--- Strategy " << strategyTag(strat) << " (" << pmodeTag(pmode) << ") for: "
+                  << count << " synthetic " << FileGenerator::profileName(opts.profile) << " records ---\n";
+
+        FileGenerator::RecordSource src(count, opts);
+        Analyzer::printPerf("Vector:", Analyzer::runVectorPipeline(src, "", "", strat, pmode));
+        src.reset();
+        Analyzer::printPerf("Deque: ", Analyzer::runDequePipeline(src, "", "", strat, pmode));
+        src.reset();
+        Analyzer::printPerf("List:  ", Analyzer::runListPipeline(src, "", "", strat, pmode));
+        src.reset();
+        Analyzer::printPerf("SegVec:", Analyzer::runSegmentedPipeline(src, "", "", strat, pmode));
+        src.reset();
+        Analyzer::printPerf("PoolLs:", Analyzer::runPooledListPipeline(src, "", "", strat, pmode));
+    }
+}
+
+static void optionStats() {
+    std::cout << "Input file paths, space-separated (e.g., data/generated/students_10000.txt): ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::istringstream in(line);
+    std::vector<std::string> files;
+    for (std::string f; in >> f;) files.push_back(f);
+    if (files.empty()) return;
+
+    try {
+        Trace::Span span("grade stats", "stats");
+        auto stats = GradeStats::scanFiles(files, Analyzer::threads());
+        double ms = span.stop();
+        GradeStats::report(std::cout, files, stats, Benchmark::OutputFormat::Text);
+        std::cout << "Scanned in " << ms << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Stats error: " << e.what() << "\n";
+    }
+}
+
+static void printEntry(const IncrementalDataset& data, IncrementalDataset::Id id) {
+    const Student& s = *data.find(id);
+    std::cout << "#" << id << " " << s.getName() << " " << s.getSurname() << " " << s.finalAvgCached()
+              << " rank " << data.rankOf(id) + 1 << "/" << data.size() << "\n";
+}
+
+static const char* const MANUAL_HELP =
+    "  load <file>                    add every student of a file\n"
+    "  add <name> <surname> <hw...> <exam>\n"
+    "  set <id> <hw...> <exam>        new grades\n"
+    "  del <id>\n"
+    "  show <id> | top [k] | count | pct <p>\n"
+    "  save <passed file> <failed file>\n"
+    "  done\n";
+
+// Every edit re-files one student in the order-statistics tree; nothing is
+// re-sorted or re-split between commands.
+static void optionManualEntry() {
+    IncrementalDataset data;
+    std::cout << MANUAL_HELP;
+    for (std::string line; std::cout << "> " && std::getline(std::cin, line);) {
+        std::istringstream in(line);
+        std::string cmd;
+        if (!(in >> cmd)) continue;
+        try {
+            if (cmd == "done") break;
+            if (cmd == "load") {
+                std::string file;
+                in >> file;
+                std::size_t n = 0;
+                for (auto& s : Analyzer::readVectorFromFile(file)) {
+                    data.add(std::move(s));
+                    ++n;
+                }
+                std::cout << "Added " << n << " students\n";
+            } else if (cmd == "add") {
+                std::string rest;
+                std::getline(in, rest);
+                RecordScanner::Record r;
+                if (!RecordScanner::parseLine(rest, r)) throw ParseException("usage: add <name> <surname> <hw...> <exam>");
+                printEntry(data, data.add(Student(std::string(r.name), std::string(r.surname), r.homework, r.exam)));
+            } else if (cmd == "set") {
+                IncrementalDataset::Id id = 0;
+                std::vector<int> grades;
+                in >> id;
+                for (int g; in >> g;) grades.push_back(g);
+                if (grades.empty()) throw ParseException("usage: set <id> <hw...> <exam>");
+                int exam = grades.back();
+                grades.pop_back();
+                if (!data.update(id, grades, exam)) throw ParseException("No student #" + std::to_string(id));
+                printEntry(data, id);
+            } else if (cmd == "del" || cmd == "show") {
+                IncrementalDataset::Id id = 0;
+                in >> id;
+                if (!data.find(id)) throw ParseException("No student #" + std::to_string(id));
+                if (cmd == "show") printEntry(data, id);
+                else data.remove(id);
+            } else if (cmd == "top") {
+                std::size_t k = 10;
+                in >> k;
+                for (std::size_t r = 0; r < k && r < data.size(); ++r) printEntry(data, data.idAt(r));
+            } else if (cmd == "count") {
+                std::cout << data.size() << " students, " << data.passed() << " passed, " << data.failed() << " failed\n";
+            } else if (cmd == "pct") {
+                double p = 0;
+                in >> p;
+                if (!(p > 0.0 && p <= 100.0)) throw ParseException("percentile must be in (0, 100]");
+                std::cout << data.percentile(p) << "\n";
+            } else if (cmd == "save") {
+                std::string pass, fail;
+                in >> pass >> fail;
+                std::ofstream p(pass), f(fail);
+                if (!p.is_open() || !f.is_open()) throw FileException("Cannot open output files");
+                data.forEachPassed([&](IncrementalDataset::Id, const Student& s) { p << s << "\n"; });
+                data.forEachFailed([&](IncrementalDataset::Id, const Student& s) { f << s << "\n"; });
+                std::cout << "Wrote " << data.passed() << " passed, " << data.failed() << " failed\n";
+            } else {
+                std::cout << MANUAL_HELP;
+            }
+        } catch (const std::exception& e) {
+            std::cout << e.what() << "\n";
+        }
+    }
+}
+
+// Folders stand for their student files (RecordScanner::folderFiles).
+static std::vector<std::string> expandInputs(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+    for (const auto& in : inputs) {
+        if (!fs::is_directory(in)) {
+            files.push_back(in);
+            continue;
+        }
+        auto more = RecordScanner::folderFiles(in);
+        files.insert(files.end(), more.begin(), more.end());
+    }
+    return files;
+}
+
+static void printStudents(const std::vector<Student>& students) {
+    std::cout << std::left << std::setw(16) << "Name" << std::setw(16) << "Surname" << std::setw(12) << "FinalAvg"
+              << std::setw(12) << "FinalMed" << "\n";
+    std::cout << std::string(56, '-') << "\n";
+    for (const auto& s : students)
+        std::cout << std::left << std::setw(16) << s.getName() << std::setw(16) << s.getSurname() << std::fixed
+                  << std::setprecision(2) << std::setw(12) << s.finalAvg() << std::setw(12) << s.finalMed() << "\n";
+    std::cout << std::right << std::defaultfloat;
+}
+
+// Neither way loads the folder: the reservoir is one streaming pass, the
+// index is one seek per student once the folder's .idx files exist.
+static void optionRandom() {
+    std::cout << "Folder to read (default: data/generated): ";
+    std::string folder;
+    std::getline(std::cin, folder);
+    if (folder.empty()) folder = "data/generated";
+    std::cout << "How many students (default 1): ";
+    std::string line;
+    std::getline(std::cin, line);
+    std::size_t k = 1;
+    if (!line.empty()) {
+        try { k = std::stoul(line); } catch (...) { k = 1; }
+    }
+    std::cout << "Use line-offset index, built on first use (y/n) [y]: ";
+    std::getline(std::cin, line);
+    const bool useIndex = line.empty() || line[0] == 'y' || line[0] == 'Y';
+
+    try {
+        auto files = RecordScanner::folderFiles(folder);
+        std::mt19937_64 rng{std::random_device{}()};
+        std::vector<Student> picked;
+        if (useIndex) {
+            std::vector<RandomStudent::LineIndex> indexes;
+            for (const auto& f : files) indexes.emplace_back(f, Analyzer::threads());
+            picked = RandomStudent::indexed(indexes, k, rng);
+        } else {
+            picked = RandomStudent::reservoir(files, k, rng);
+        }
+        if (picked.empty()) {
+            std::cout << "No student records found.\n";
+            return;
+        }
+        printStudents(picked);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+    }
+}
+
+static void optionHighLow() {
+    std::cout << "Folder to read (default: data/generated): ";
+    std::string folder;
+    std::getline(std::cin, folder);
+    if (folder.empty()) folder = "data/generated";
+
+    try {
+        auto files = RecordScanner::folderFiles(folder);
+        Trace::Span span("high low", "aggregate");
+        auto summary = Aggregate::scanFiles(files, Analyzer::threads());
+        double ms = span.stop();
+        Aggregate::report(std::cout, files, summary, Benchmark::OutputFormat::Text);
+        std::cout << "Scanned in " << ms << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+    }
+}
+
+// Where SGC_TRACE=1 runs leave their Chrome trace.
+static const char* const DEFAULT_TRACE_PATH = "trace.json";
+
+static void flushTrace(const std::string& path) {
+    if (!Trace::enabled() || Trace::spanCount() == 0) return;
+    try {
+        Trace::writeChromeJson(path);
+        std::cerr << "Trace written: " << path << " (" << Trace::spanCount() << " spans)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Trace error: " << e.what() << "\n";
+    }
+}
+
+// generate <count> <out path | -> [profile] [seed]
+static int commandGenerate(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " generate <count> <out path | -> [profile] [seed]\n";
+        return 2;
+    }
+    try {
+        FileGenerator::GeneratorOptions opts;
+        if (argc > 4) opts.profile = FileGenerator::profileFromName(argv[4]);
+        if (argc > 5) opts.seed = std::stoull(argv[5]);
+        FileGenerator::generateFile(argv[3], std::stoull(argv[2]), opts);
+    } catch (const std::exception& e) {
+        std::cerr << "Generate error: " << e.what() << "\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// bench [options] <input>...  (see Benchmark::usage)
+static int commandBench(int argc, char** argv) {
+    try {
+        auto cfg = Benchmark::parseArgs(std::vector<std::string>(argv + 2, argv + argc));
+        auto cases = Benchmark::run(cfg);
+
+        if (cfg.outPath.empty()) {
+            Benchmark::report(std::cout, cases, cfg.format);
+        } else {
+            std::ofstream out(cfg.outPath);
+            if (!out.is_open()) throw FileException("Cannot open file for writing: " + cfg.outPath);
+            Benchmark::report(out, cases, cfg.format);
+        }
+        flushTrace(cfg.tracePath.empty() ? DEFAULT_TRACE_PATH : cfg.tracePath);
+    } catch (const ParseException& e) {
+        std::cerr << e.what() << "\n" << Benchmark::usage();
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// sweep [options] [<input>...]  (see Benchmark::sweepUsage)
+static int commandSweep(int argc, char** argv) {
+    try {
+        auto cfg = Benchmark::parseSweepArgs(std::vector<std::string>(argv + 2, argv + argc));
+        auto cases = Benchmark::run(cfg);
+
+        if (cfg.outPath.empty()) {
+            Benchmark::reportScaling(std::cout, cases, cfg.format);
+        } else {
+            std::ofstream out(cfg.outPath);
+            if (!out.is_open()) throw FileException("Cannot open file for writing: " + cfg.outPath);
+            Benchmark::reportScaling(out, cases, cfg.format);
+        }
+        flushTrace(cfg.tracePath.empty() ? DEFAULT_TRACE_PATH : cfg.tracePath);
+    } catch (const ParseException& e) {
+        std::cerr << e.what() << "\n" << Benchmark::sweepUsage() << Benchmark::usage();
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Sweep error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// compare [options] <input>...  (see Compare::usage)
+static int commandCompare(int argc, char** argv) {
+    try {
+        auto cfg = Compare::parseArgs(std::vector<std::string>(argv + 2, argv + argc));
+        auto cases = Compare::run(cfg);
+
+        if (cfg.outPath.empty()) {
+            Compare::report(std::cout, cases, cfg.format);
+        } else {
+            std::ofstream out(cfg.outPath);
+            if (!out.is_open()) throw FileException("Cannot open file for writing: " + cfg.outPath);
+            Compare::report(out, cases, cfg.format);
+        }
+    } catch (const ParseException& e) {
+        std::cerr << e.what() << "\n" << Compare::usage();
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Compare error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// serve [--socket PATH] [--workers N] <file>...
+static int commandServe(int argc, char** argv) {
+    QueryServer::ServerConfig cfg;
+    std::vector<std::string> files;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--socket" || a == "--workers") && i + 1 >= argc) throw ParseException("Missing value for " + a);
+            if (a == "--socket") cfg.socketPath = argv[++i];
+            else if (a == "--workers") cfg.workers = static_cast<unsigned>(std::stoul(argv[++i]));
+            else if (!a.empty() && a[0] == '-') throw ParseException("Unknown option: " + a);
+            else files.push_back(a);
+        }
+        if (files.empty()) throw ParseException("No input files given");
+
+        Trace::Span span("load dataset", "server");
+        auto data = QueryServer::Dataset::load(files);
+        std::cerr << "Loaded " << data.size() << " students in " << span.stop() << " ms\n";
+        QueryServer::serve(data, cfg);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " serve [--socket PATH] [--workers N] <file>...\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// query [--socket PATH] [--repeat N] <request...>
+// --repeat sends the request N times and reports round-trip latency.
+static int commandQuery(int argc, char** argv) {
+    std::string socketPath = QueryServer::ServerConfig{}.socketPath;
+    int repeat = 1;
+    std::string request;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--socket" || a == "--repeat") && i + 1 >= argc) throw ParseException("Missing value for " + a);
+            if (a == "--socket") socketPath = argv[++i];
+            else if (a == "--repeat") repeat = std::max(1, std::stoi(argv[++i]));
+            else request += (request.empty() ? "" : " ") + a;
+        }
+        if (request.empty()) throw ParseException("No request given");
+
+        QueryServer::Client client(socketPath);
+        std::string response;
+        std::vector<double> us;
+        for (int i = 0; i < repeat; ++i) {
+            Trace::Span span("query round trip", "client");
+            response = client.request(request);
+            us.push_back(span.stop() * 1000.0);
+        }
+        std::cout << response;
+        if (repeat > 1) {
+            auto st = Benchmark::summarize(us);
+            std::cerr << repeat << " requests, round trip us: median " << st.median << ", mean " << st.mean
+                      << ", p95 " << st.p95 << ", min " << st.min << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " query [--socket PATH] [--repeat N] <request...>\n";
+        return 1;
+    }
+    return 0;
+}
+
+// search [--prefix] [--field any|name|surname] [--limit N] [--verify] <text> <file>...
+// Builds the trigram index, reports its build time and size, and prints the
+// matches in input order; --verify also runs the full scan and compares.
+static int commandSearch(int argc, char** argv) {
+    bool prefix = false, verify = false;
+    auto field = NameSearch::Field::Any;
+    std::size_t limit = 20;
+    std::vector<std::string> args;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--field" || a == "--limit") && i + 1 >= argc) throw ParseException("Missing value for " + a);
+            if (a == "--prefix") prefix = true;
+            else if (a == "--verify") verify = true;
+            else if (a == "--field") field = searchFieldFromName(argv[++i]);
+            else if (a == "--limit") limit = std::stoull(argv[++i]);
+            else if (!a.empty() && a[0] == '-') throw ParseException("Unknown option: " + a);
+            else args.push_back(a);
+        }
+        if (args.size() < 2) throw ParseException("Need a search text and at least one file");
+        const std::string& text = args[0];
+
+        std::vector<Student> students;
+        for (std::size_t i = 1; i < args.size(); ++i) {
+            auto part = Analyzer::readVectorFromFile(args[i]);
+            std::move(part.begin(), part.end(), std::back_inserter(students));
+        }
+
+        Trace::Span build("name search build", "search");
+        NameSearch index(students, Analyzer::threads());
+        double buildMs = build.stop();
+        std::cerr << "Indexed " << students.size() << " students in " << buildMs << " ms, "
+                  << index.memoryBytes() / (1024.0 * 1024.0) << " MiB ("
+                  << (students.empty() ? 0.0 : static_cast<double>(index.memoryBytes()) / students.size())
+                  << " bytes/student)\n";
+
+        Trace::Span query("name search query", "search");
+        auto hits = prefix ? index.findPrefix(text, field) : index.findSubstring(text, field);
+        double queryMs = query.stop();
+        std::cerr << hits.size() << " matches in " << queryMs * 1000.0 << " us\n";
+
+        for (std::size_t i = 0; i < hits.size() && i < limit; ++i) {
+            const Student& s = students[hits[i]];
+            std::cout << s.getName() << " " << s.getSurname() << " " << s.finalAvgCached() << "\n";
+        }
+        if (hits.size() > limit) std::cout << "... " << hits.size() - limit << " more\n";
+
+        if (verify) {
+            Trace::Span scan("name search scan", "search");
+            auto expected = prefix ? NameSearch::scanPrefix(students, text, field)
+                                   : NameSearch::scanSubstring(students, text, field);
+            double scanMs = scan.stop();
+            bool same = expected == hits;
+            std::cerr << "Full scan: " << expected.size() << " matches in " << scanMs << " ms, "
+                      << (same ? "identical" : "DIFFERENT") << "\n";
+            if (!same) return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0]
+                  << " search [--prefix] [--field any|name|surname] [--limit N] [--verify] <text> <file>...\n";
+        return 1;
     }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
 }
 
-int main() {
+// stats [--format text|json|csv] [--out PATH] <file>...
+// One streaming pass over the files on Analyzer::threads() workers.
+static int commandStats(int argc, char** argv) {
+    auto format = Benchmark::OutputFormat::Text;
+    std::string outPath;
+    std::vector<std::string> files;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--format" || a == "--out") && i + 1 >= argc) throw ParseException("Missing value for " + a);
+            if (a == "--format") {
+                format = Benchmark::parseReportFormat(argv[++i]);
+            } else if (a == "--out") {
+                outPath = argv[++i];
+            } else if (!a.empty() && a[0] == '-') {
+                throw ParseException("Unknown option: " + a);
+            } else {
+                files.push_back(a);
+            }
+        }
+        if (files.empty()) throw ParseException("No input files given");
+
+        Trace::Span span("grade stats", "stats");
+        auto stats = GradeStats::scanFiles(files, Analyzer::threads());
+        std::cerr << "Scanned " << stats.records << " students in " << span.stop() << " ms\n";
+
+        if (outPath.empty()) {
+            GradeStats::report(std::cout, files, stats, format);
+        } else {
+            std::ofstream out(outPath);
+            if (!out.is_open()) throw FileException("Cannot open file for writing: " + outPath);
+            GradeStats::report(out, files, stats, format);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " stats [--format text|json|csv] [--out PATH] <file>...\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// random [--k N] [--index] [--seed S] <folder|file>...
+// k students drawn uniformly over all records of the inputs: by one
+// reservoir-sampling pass, or with --index through the per-file .idx
+// line-offset indexes (built or refreshed first when needed).
+static int commandRandom(int argc, char** argv) {
+    std::size_t k = 1;
+    bool useIndex = false;
+    std::uint64_t seed = std::random_device{}();
+    std::vector<std::string> inputs;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--k" || a == "--seed") && i + 1 >= argc) throw ParseException("Missing value for " + a);
+            if (a == "--k") k = std::stoul(argv[++i]);
+            else if (a == "--seed") seed = std::stoull(argv[++i]);
+            else if (a == "--index") useIndex = true;
+            else if (!a.empty() && a[0] == '-') throw ParseException("Unknown option: " + a);
+            else inputs.push_back(a);
+        }
+        if (inputs.empty()) throw ParseException("No input given");
+        auto files = expandInputs(inputs);
+
+        std::mt19937_64 rng{seed};
+        std::vector<Student> picked;
+        if (useIndex) {
+            Trace::Span span("open line indexes", "random");
+            std::vector<RandomStudent::LineIndex> indexes;
+            std::size_t built = 0;
+            for (const auto& f : files) {
+                indexes.emplace_back(f, Analyzer::threads());
+                built += indexes.back().built() ? 1 : 0;
+            }
+            std::cerr << "Opened " << indexes.size() << " indexes (" << built << " built) in " << span.stop() << " ms\n";
+            Trace::Span pick("pick", "random");
+            picked = RandomStudent::indexed(indexes, k, rng);
+            std::cerr << "Picked " << picked.size() << " in " << pick.stop() * 1000.0 << " us\n";
+        } else {
+            Trace::Span span("reservoir pass", "random");
+            picked = RandomStudent::reservoir(files, k, rng);
+            std::cerr << "Sampled " << picked.size() << " in " << span.stop() << " ms\n";
+        }
+        printStudents(picked);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " random [--k N] [--index] [--seed S] <folder|file>...\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// highlow [--ties N] [--format text|json|csv] [--out PATH] <folder|file>...
+// Highest/lowest final grade with up to N tied students each (default 10),
+// count, mean and pass/fail from one pass on Analyzer::threads() workers.
+static int commandHighLow(int argc, char** argv) {
+    auto format = Benchmark::OutputFormat::Text;
+    std::size_t keep = 10;
+    std::string outPath;
+    std::vector<std::string> inputs;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--ties" || a == "--format" || a == "--out") && i + 1 >= argc)
+                throw ParseException("Missing value for " + a);
+            if (a == "--ties") {
+                keep = std::stoul(argv[++i]);
+            } else if (a == "--format") {
+                format = Benchmark::parseReportFormat(argv[++i]);
+            } else if (a == "--out") {
+                outPath = argv[++i];
+            } else if (!a.empty() && a[0] == '-') {
+                throw ParseException("Unknown option: " + a);
+            } else {
+                inputs.push_back(a);
+            }
+        }
+        if (inputs.empty()) throw ParseException("No input given");
+        auto files = expandInputs(inputs);
+
+        Trace::Span span("high low", "aggregate");
+        auto summary = Aggregate::scanFiles(files, Analyzer::threads(), keep);
+        std::cerr << "Scanned " << summary.records << " students in " << files.size() << " files in " << span.stop()
+                  << " ms\n";
+
+        if (outPath.empty()) {
+            Aggregate::report(std::cout, files, summary, format);
+        } else {
+            std::ofstream out(outPath);
+            if (!out.is_open()) throw FileException("Cannot open file for writing: " + outPath);
+            Aggregate::report(out, files, summary, format);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " highlow [--ties N] [--format text|json|csv] [--out PATH] <folder|file>...\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// extsort [--memory SIZE] [--temp DIR] [--runs text|binary] [--order grade|total]
+//         [--passed PATH] [--failed PATH] <input>...
+// Sorted passed/failed files for inputs larger than memory: runs of at most
+// SIZE (default 1G) are sorted on Analyzer::threads() workers, spilled under
+// DIR and merged. Outputs default to <first input>.extsort.{passed,failed}.txt.
+static int commandExtSort(int argc, char** argv) {
+    ExternalSort::Config cfg;
+    cfg.threads = Analyzer::threads();
+    std::string outPass, outFail;
+    std::vector<std::string> inputs;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--memory" || a == "--temp" || a == "--runs" || a == "--order" || a == "--passed"
+                 || a == "--failed") && i + 1 >= argc)
+                throw ParseException("Missing value for " + a);
+            if (a == "--memory") cfg.memoryBytes = ExternalSort::sizeFromText(argv[++i]);
+            else if (a == "--temp") cfg.tempDir = argv[++i];
+            else if (a == "--runs") cfg.runFormat = ExternalSort::runFormatFromName(argv[++i]);
+            else if (a == "--order") Sorter::setOrder(Sorter::orderFromName(argv[++i]));
+            else if (a == "--passed") outPass = argv[++i];
+            else if (a == "--failed") outFail = argv[++i];
+            else if (!a.empty() && a[0] == '-') throw ParseException("Unknown option: " + a);
+            else inputs.push_back(a);
+        }
+        if (inputs.empty()) throw ParseException("No input files given");
+        if (cfg.memoryBytes < ExternalSort::MIN_MEMORY)
+            throw ParseException("--memory must be at least " + std::to_string(ExternalSort::MIN_MEMORY >> 10) + "K");
+        if (outPass.empty()) outPass = inputs.front() + ".extsort.passed.txt";
+        if (outFail.empty()) outFail = inputs.front() + ".extsort.failed.txt";
+
+        auto res = ExternalSort::sortFiles(inputs, outPass, outFail, cfg);
+        std::cerr << "Sorted " << res.records << " students (" << res.passed << " passed, "
+                  << res.records - res.passed << " failed), order " << Sorter::orderName(Sorter::order()) << "\n"
+                  << "Runs: " << res.runs << " " << ExternalSort::runFormatName(cfg.runFormat) << ", "
+                  << res.spilledBytes / (1 << 20) << " MiB spilled, " << res.mergePasses << " extra merge passes\n"
+                  << "Run phase " << res.runMs << " ms, merge " << res.mergeMs << " ms\n"
+                  << "Wrote " << outPass << " and " << outFail << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " extsort [--memory SIZE] [--temp DIR] [--runs text|binary]"
+                  << " [--order grade|total] [--passed PATH] [--failed PATH] <input>...\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// shard [--workers N] [--work DIR] [--order grade|total] [--passed PATH]
+//       [--failed PATH] <input>
+// Sorted passed/failed files from N worker processes (default: one per
+// hardware thread), each running the pipeline on a line-aligned byte range
+// of the input; their outputs, kept under DIR, are merged. Workers sort on
+// Analyzer::threads() threads each. Outputs default to
+// <input>.shard.{passed,failed}.txt.
+static int commandShard(int argc, char** argv) {
+    Shard::Config cfg;
+    std::string outPass, outFail;
+    std::vector<std::string> inputs;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            if ((a == "--workers" || a == "--work" || a == "--order" || a == "--passed" || a == "--failed")
+                && i + 1 >= argc)
+                throw ParseException("Missing value for " + a);
+            if (a == "--workers") {
+                int n = std::stoi(argv[++i]);
+                if (n < 1 || n > static_cast<int>(Shard::MAX_WORKERS))
+                    throw ParseException("--workers must be 1.." + std::to_string(Shard::MAX_WORKERS));
+                cfg.workers = static_cast<unsigned>(n);
+            } else if (a == "--work") cfg.workDir = argv[++i];
+            else if (a == "--order") Sorter::setOrder(Sorter::orderFromName(argv[++i]));
+            else if (a == "--passed") outPass = argv[++i];
+            else if (a == "--failed") outFail = argv[++i];
+            else if (!a.empty() && a[0] == '-') throw ParseException("Unknown option: " + a);
+            else inputs.push_back(a);
+        }
+        if (inputs.size() != 1) throw ParseException("Give exactly one input file");
+        if (outPass.empty()) outPass = inputs.front() + ".shard.passed.txt";
+        if (outFail.empty()) outFail = inputs.front() + ".shard.failed.txt";
+
+        auto res = Shard::run(inputs.front(), outPass, outFail, cfg);
+        std::cerr << "Sorted " << res.records << " students (" << res.passed << " passed, "
+                  << res.records - res.passed << " failed), order " << Sorter::orderName(Sorter::order()) << "\n"
+                  << std::fixed << std::setprecision(2);
+        std::cerr << std::left << std::setw(8) << "Shard" << std::right << std::setw(10) << "Students"
+                  << std::setw(10) << "Read" << std::setw(10) << "Sort" << std::setw(10) << "Split"
+                  << std::setw(10) << "Write" << std::setw(10) << "Total" << "\n";
+        for (std::size_t k = 0; k < res.shards.size(); ++k) {
+            const PerfResult& r = res.shards[k];
+            std::cerr << std::left << std::setw(8) << k << std::right << std::setw(10) << r.total_students
+                      << std::setw(10) << r.read_ms << std::setw(10) << r.sort_ms << std::setw(10) << r.split_ms
+                      << std::setw(10) << r.write_ms << std::setw(10) << r.total_ms << "\n";
+        }
+        std::cerr << "Plan " << res.planMs << " ms, workers " << res.workMs << " ms, merge " << res.mergeMs
+                  << " ms, total " << res.totalMs << " ms\n"
+                  << std::defaultfloat << "Wrote " << outPass << " and " << outFail << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "usage: " << argv[0] << " shard [--workers N] [--work DIR] [--order grade|total]"
+                  << " [--passed PATH] [--failed PATH] <input>\n";
+        return 1;
+    }
+    flushTrace(DEFAULT_TRACE_PATH);
+    return 0;
+}
+
+// shard-worker <task args>: one shard of a "shard" run (see Shard::taskArgs).
+// Prints the stage timings on stdout for the coordinator; writes no trace,
+// which would overwrite the coordinator's.
+static int commandShardWorker(int argc, char** argv) {
+    try {
+        auto task = Shard::taskFromArgs(std::vector<std::string>(argv + 2, argv + argc));
+        std::cout << Shard::resultLine(Shard::runTask(task)) << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "shard-worker: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Trace::setThreadName("main");
+    if (argc > 1 && std::string(argv[1]) == "generate") return commandGenerate(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "bench") return commandBench(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "sweep") return commandSweep(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "compare") return commandCompare(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "serve") return commandServe(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "query") return commandQuery(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "search") return commandSearch(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "stats") return commandStats(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "random") return commandRandom(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "highlow") return commandHighLow(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "extsort") return commandExtSort(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "shard") return commandShard(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "shard-worker") return commandShardWorker(argc, argv);
+
     fs::create_directories("data/generated");
 
     while (true) {
@@ -116,8 +932,14 @@ int main() {
         if (c == 1) optionGenerate();
         else if (c == 2) optionRunOne();
         else if (c == 3) optionRunAll();
-        else if (c == 4) {
+        else if (c == 4) optionRunInMemory();
+        else if (c == 5) optionStats();
+        else if (c == 6) optionManualEntry();
+        else if (c == 7) optionRandom();
+        else if (c == 8) optionHighLow();
+        else if (c == 9) {
             std::cout << "Goodbye!\n";
+            flushTrace(DEFAULT_TRACE_PATH);
             break;
         } else {
             std::cout << "Invalid choice.\n";
@@ -0,0 +1,25 @@
+# Helpers for the command-line checks, run in script mode with -DSGC=<calculator>
+# and -DWORK=<scratch dir>. sgc() runs one command in WORK and stops the test
+# with its stderr when it fails.
+
+file(REMOVE_RECURSE "${WORK}")
+file(MAKE_DIRECTORY "${WORK}")
+
+function(sgc)
+    execute_process(COMMAND "${SGC}" ${ARGN} WORKING_DIRECTORY "${WORK}"
+                    RESULT_VARIABLE rc OUTPUT_QUIET ERROR_VARIABLE err)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "${SGC} ${ARGN} failed (${rc}):\n${err}")
+    endif()
+endfunction()
+
+# <a>.passed.txt / <a>.failed.txt in WORK must equal <b>'s byte for byte
+function(expect_same a b)
+    foreach(part passed failed)
+        file(READ "${WORK}/${a}.${part}.txt" left)
+        file(READ "${WORK}/${b}.${part}.txt" right)
+        if(NOT left STREQUAL right)
+            message(FATAL_ERROR "${a}.${part}.txt and ${b}.${part}.txt differ")
+        endif()
+    endforeach()
+endfunction()
@@ -0,0 +1,9 @@
+# search --verify: the index and the full scan agree on the command line too.
+include("${CMAKE_CURRENT_LIST_DIR}/CliUtil.cmake")
+
+sgc(generate 20000 "${WORK}/students.txt" realistic)
+sgc(search --verify Pav "${WORK}/students.txt")
+sgc(search --verify --prefix --field surname Pa "${WORK}/students.txt")
+sgc(search --verify --field name a "${WORK}/students.txt")
+
+file(REMOVE_RECURSE "${WORK}")
@@ -0,0 +1,17 @@
+# With --order total, shard (worker processes re-executed from the calculator)
+# writes the same bytes as extsort, which test_extsort holds to the in-memory
+# pipeline.
+include("${CMAKE_CURRENT_LIST_DIR}/CliUtil.cmake")
+
+sgc(generate 20000 "${WORK}/students.txt" realistic)
+sgc(extsort --order total --temp "${WORK}" --passed "${WORK}/ext.passed.txt" --failed "${WORK}/ext.failed.txt"
+    "${WORK}/students.txt")
+
+foreach(workers 1 3)
+    sgc(shard --order total --workers ${workers} --work "${WORK}/shard-${workers}"
+        --passed "${WORK}/shard-${workers}.passed.txt" --failed "${WORK}/shard-${workers}.failed.txt"
+        "${WORK}/students.txt")
+    expect_same(ext shard-${workers})
+endforeach()
+
+file(REMOVE_RECURSE "${WORK}")
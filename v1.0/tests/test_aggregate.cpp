@@ -0,0 +1,91 @@
+// Aggregate::scanFiles on one worker or several, over many small chunks,
+// finds what loading every record finds: the highest and lowest final grade,
+// how many records tie on each, and the first `keep` holders in input order
+// (file, then offset), plus the record and pass counts.
+#include "Aggregate.h"
+#include "FileGenerator.h"
+#include "Pipeline.h"
+#include "TestUtil.h"
+
+#include <algorithm>
+#include <sstream>
+
+struct Loaded {
+    Student student;
+    std::size_t file;
+    std::uint64_t offset;
+};
+
+// Every record of every file with where its line starts
+static std::vector<Loaded> loadAll(const std::vector<std::string>& files) {
+    std::vector<Loaded> out;
+    for (std::size_t f = 0; f < files.size(); ++f) {
+        const std::string text = TestUtil::readAll(files[f]);
+        std::size_t at = 0;
+        while (at < text.size()) {
+            std::size_t end = text.find('\n', at);
+            if (end == std::string::npos) end = text.size();
+            std::istringstream line(text.substr(at, end - at));
+            Student s;
+            line >> s;
+            if (s.isValidBasic()) out.push_back({s, f, at});
+            at = end + 1;
+        }
+    }
+    return out;
+}
+
+static void checkExtreme(const Aggregate::Extreme& x, const std::vector<Loaded>& all, bool high, std::size_t keep) {
+    double best = all.front().student.finalAvg();
+    for (const auto& l : all) {
+        const double g = l.student.finalAvg();
+        best = high ? std::max(best, g) : std::min(best, g);
+    }
+
+    std::vector<const Loaded*> holders;
+    for (const auto& l : all)
+        if (l.student.finalAvg() == best) holders.push_back(&l);
+    CHECK(holders.size() > 7); // enough ties to cut the holder list
+    CHECK(x.grade.value() == best);
+    CHECK(x.ties == holders.size());
+    CHECK(x.holders.size() == std::min(keep, holders.size()));
+    for (std::size_t i = 0; i < x.holders.size(); ++i) {
+        CHECK(x.holders[i].name == holders[i]->student.getName());
+        CHECK(x.holders[i].surname == holders[i]->student.getSurname());
+        CHECK(x.holders[i].file == holders[i]->file);
+        CHECK(x.holders[i].offset == holders[i]->offset);
+    }
+}
+
+int main() {
+    TestUtil::ScratchDir scratch;
+    // one homework grade: final grades 10 and 0 each tie for ~1/121 of the records
+    std::vector<std::string> files;
+    for (auto profile : {FileGenerator::WorkloadProfile::Uniform, FileGenerator::WorkloadProfile::Students,
+                         FileGenerator::WorkloadProfile::Uniform}) {
+        FileGenerator::GeneratorOptions opts;
+        opts.profile = profile;
+        opts.hwPerStudent = 1;
+        opts.seed = files.size() + 1;
+        files.push_back(scratch.file("part" + std::to_string(files.size()) + ".txt"));
+        FileGenerator::generateFile(files.back(), 10000, opts);
+    }
+
+    const auto all = loadAll(files);
+    std::uint64_t passed = 0;
+    for (const auto& l : all)
+        if (Pipeline::isPassed(l.student)) ++passed;
+
+    for (std::uint64_t chunkBytes : {Aggregate::CHUNK_BYTES, std::uint64_t{4096}, std::uint64_t{100}}) {
+        for (unsigned threads : {1u, 3u, 4u}) {
+            for (std::size_t keep : {1, 7, 100000}) {
+                const auto s = Aggregate::scanFiles(files, threads, keep, chunkBytes);
+                CHECK(s.records == all.size());
+                CHECK(s.passed == passed);
+                checkExtreme(s.highest, all, true, keep);
+                checkExtreme(s.lowest, all, false, keep);
+            }
+        }
+    }
+    return 0;
+}
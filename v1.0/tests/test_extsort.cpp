@@ -0,0 +1,117 @@
+// ExternalSort writes what the in-memory pipeline writes, with text and binary
+// runs, in one run or through many merge passes: byte-identical in total
+// order; in grade order the same records with the same grade sequence.
+#include "Analyzer.h"
+#include "ExceptionHandlers.h"
+#include "ExternalSort.h"
+#include "FileGenerator.h"
+#include "Sorter.h"
+#include "TestUtil.h"
+
+#include <algorithm>
+#include <sstream>
+
+struct Outputs {
+    std::string passed;
+    std::string failed;
+};
+
+static Outputs readOutputs(const TestUtil::ScratchDir& scratch) {
+    return {TestUtil::readAll(scratch.file("passed.txt")), TestUtil::readAll(scratch.file("failed.txt"))};
+}
+
+static Outputs runInMemory(const std::string& input, const TestUtil::ScratchDir& scratch) {
+    Analyzer::runVectorPipeline(input, scratch.file("passed.txt"), scratch.file("failed.txt"),
+                                SplitStrategy::Strategy2_MoveFailAndShrinkBase, PartitionMode::Partition);
+    return readOutputs(scratch);
+}
+
+static Outputs runExternal(const std::string& input, std::size_t memory, ExternalSort::RunFormat format,
+                           unsigned threads, const TestUtil::ScratchDir& scratch) {
+    ExternalSort::Config cfg;
+    cfg.memoryBytes = memory;
+    cfg.runFormat = format;
+    cfg.threads = threads;
+    cfg.tempDir = scratch.path.string();
+    ExternalSort::sortFiles({input}, scratch.file("passed.txt"), scratch.file("failed.txt"), cfg);
+    return readOutputs(scratch);
+}
+
+static bool rejectsSize(const std::string& text) {
+    try {
+        ExternalSort::sizeFromText(text);
+    } catch (const ParseException&) {
+        return true;
+    }
+    return false;
+}
+
+static std::vector<std::string> sortedLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+// The final grades in file order, read back through Person
+static std::vector<double> grades(const std::string& text) {
+    std::vector<double> out;
+    std::istringstream in(text);
+    for (Student s; in >> s;) {
+        if (!s.getName().empty()) out.push_back(s.finalAvgCached());
+    }
+    return out;
+}
+
+int main() {
+    TestUtil::ScratchDir scratch;
+    const std::string input = scratch.file("students.txt");
+    FileGenerator::GeneratorOptions gen;
+    gen.profile = FileGenerator::WorkloadProfile::Realistic; // duplicate surnames: many ties
+    FileGenerator::generateFile(input, 20000, gen);
+
+    const auto formats = {ExternalSort::RunFormat::Text, ExternalSort::RunFormat::Binary};
+    const std::size_t memories[] = {std::size_t{1} << 30, 256 << 10, ExternalSort::MIN_MEMORY}; // 1 run, few, many
+    Analyzer::setThreads(1);
+
+    Sorter::setOrder(Sorter::SortOrder::Total);
+    const Outputs total = runInMemory(input, scratch);
+    CHECK(!total.passed.empty() && !total.failed.empty());
+    for (auto format : formats) {
+        for (std::size_t memory : memories) {
+            for (unsigned threads : {1u, 3u}) {
+                const Outputs o = runExternal(input, memory, format, threads, scratch);
+                CHECK(o.passed == total.passed);
+                CHECK(o.failed == total.failed);
+            }
+        }
+    }
+
+    // grade order: ties may come out in any order, grades may not
+    Sorter::setOrder(Sorter::SortOrder::Grade);
+    const Outputs byGrade = runInMemory(input, scratch);
+    for (auto format : formats) {
+        for (std::size_t memory : memories) {
+            const Outputs o = runExternal(input, memory, format, 1, scratch);
+            CHECK(sortedLines(o.passed) == sortedLines(byGrade.passed));
+            CHECK(sortedLines(o.failed) == sortedLines(byGrade.failed));
+            CHECK(grades(o.passed) == grades(byGrade.passed));
+            CHECK(grades(o.failed) == grades(byGrade.failed));
+        }
+    }
+
+    // sizes: no sign, no blanks; a budget below MIN_MEMORY is raised to it
+    CHECK(ExternalSort::sizeFromText("64K") == 64 << 10);
+    CHECK(ExternalSort::sizeFromText("3") == 3);
+    for (const char* bad : {"-5", " 5", "+5", "", "5X", "K"}) CHECK(rejectsSize(bad));
+    ExternalSort::Config tiny;
+    tiny.memoryBytes = 1;
+    tiny.tempDir = scratch.path.string();
+    ExternalSort::Config floor = tiny;
+    floor.memoryBytes = ExternalSort::MIN_MEMORY;
+    const auto tinyRuns = ExternalSort::sortFiles({input}, scratch.file("passed.txt"), scratch.file("failed.txt"), tiny);
+    const auto floorRuns = ExternalSort::sortFiles({input}, scratch.file("passed.txt"), scratch.file("failed.txt"), floor);
+    CHECK(tinyRuns.runs == floorRuns.runs && tinyRuns.runs > 1);
+    return 0;
+}
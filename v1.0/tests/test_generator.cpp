@@ -0,0 +1,37 @@
+// Generated files read back as exactly the records written, through every
+// reader: Person's operator>> (the pipelines) and RecordScanner (the
+// streaming commands); RecordSource yields the same count.
+#include "Analyzer.h"
+#include "FileGenerator.h"
+#include "RecordScanner.h"
+#include "TestUtil.h"
+
+#include <limits>
+
+int main() {
+    TestUtil::ScratchDir scratch;
+    const std::uint64_t count = 2345;
+
+    for (auto profile : FileGenerator::allProfiles()) {
+        for (bool padded : {false, true}) {
+            FileGenerator::GeneratorOptions opts;
+            opts.profile = profile;
+            opts.paddedLayout = padded;
+            opts.threads = 3;
+            const std::string path = scratch.file(FileGenerator::profileName(profile) + ".txt");
+            FileGenerator::generateFile(path, count, opts);
+
+            const auto students = Analyzer::readVectorFromFile(path);
+            CHECK(students.size() == count);
+
+            std::uint64_t scanned = 0;
+            RecordScanner::forEachRecord(path, 0, std::numeric_limits<std::uint64_t>::max(),
+                                         [&](const RecordScanner::Record&) { ++scanned; });
+            CHECK(scanned == count);
+
+            FileGenerator::RecordSource source(count, opts);
+            CHECK(Analyzer::readVectorFromSource(source).size() == count);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// GradeStats::scanFile, on one thread or several, gives what sorting the
+// loaded students' finalAvg and finalMed gives: record and pass counts,
+// min/max, nearest-rank percentiles, mean and population stddev.
+#include "Analyzer.h"
+#include "FileGenerator.h"
+#include "GradeStats.h"
+#include "Pipeline.h"
+#include "TestUtil.h"
+
+#include <algorithm>
+#include <cmath>
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+// grades sorted ascending, as the reference for one histogram
+static void checkHistogram(const GradeStats::Histogram& h, std::vector<double> grades) {
+    std::sort(grades.begin(), grades.end());
+    const std::size_t n = grades.size();
+    CHECK(h.count() == n);
+    CHECK(near(h.min().value(), grades.front()));
+    CHECK(near(h.max().value(), grades.back()));
+
+    for (double p : {0.01, 1.0, 10.0, 25.0, 50.0, 75.0, 90.0, 99.0, 99.99, 100.0}) {
+        auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+        rank = std::clamp<std::size_t>(rank, 1, n);
+        CHECK(near(h.percentile(p).value(), grades[rank - 1]));
+    }
+
+    double sum = 0.0;
+    for (double g : grades) sum += g;
+    const double mean = sum / static_cast<double>(n);
+    double squares = 0.0;
+    for (double g : grades) squares += (g - mean) * (g - mean);
+    CHECK(near(h.mean(), mean));
+    CHECK(near(h.stddev(), std::sqrt(squares / static_cast<double>(n))));
+}
+
+int main() {
+    TestUtil::ScratchDir scratch;
+    const FileGenerator::WorkloadProfile profiles[] = {FileGenerator::WorkloadProfile::Realistic,
+                                                       FileGenerator::WorkloadProfile::VariableHomework,
+                                                       FileGenerator::WorkloadProfile::Students};
+    for (auto profile : profiles) {
+        FileGenerator::GeneratorOptions opts;
+        opts.profile = profile;
+        const std::string path = scratch.file(FileGenerator::profileName(profile) + ".txt");
+        FileGenerator::generateFile(path, 30000, opts);
+
+        const auto students = Analyzer::readVectorFromFile(path);
+        std::vector<double> avg, med;
+        std::uint64_t passed = 0;
+        for (const auto& s : students) {
+            avg.push_back(s.finalAvg());
+            med.push_back(s.finalMed());
+            if (Pipeline::isPassed(s)) ++passed;
+        }
+
+        for (unsigned threads : {1u, 2u, 3u, 5u}) {
+            const GradeStats::Stats stats = GradeStats::scanFile(path, threads);
+            CHECK(stats.records == students.size());
+            CHECK(stats.passed == passed);
+            checkHistogram(stats.finalAvg, avg);
+            checkHistogram(stats.finalMed, med);
+        }
+    }
+    return 0;
+}
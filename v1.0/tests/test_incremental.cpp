@@ -0,0 +1,114 @@
+// IncrementalDataset under 20k random adds, regrades and removes agrees with
+// a reference re-sorted from scratch: the order (grade descending, then id),
+// rankOf/byRank/idAt, percentiles, the pass count and the passed/failed split.
+#include "IncrementalDataset.h"
+#include "Pipeline.h"
+#include "TestUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+
+using Id = IncrementalDataset::Id;
+
+static std::vector<int> randomHomework(std::mt19937_64& rng) {
+    std::vector<int> hw(1 + rng() % 5);
+    for (int& g : hw) g = static_cast<int>(rng() % 11);
+    return hw;
+}
+
+// (grade, id) in the dataset's order
+static std::vector<std::pair<double, Id>> sortedReference(const std::map<Id, Student>& live) {
+    std::vector<std::pair<double, Id>> order;
+    for (const auto& [id, s] : live) order.emplace_back(s.finalAvgCached(), id);
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    return order;
+}
+
+static void checkAll(const IncrementalDataset& d, const std::map<Id, Student>& live) {
+    const auto order = sortedReference(live);
+    CHECK(d.size() == order.size());
+
+    std::size_t passed = 0;
+    for (std::size_t r = 0; r < order.size(); ++r) {
+        CHECK(d.idAt(r) == order[r].second);
+        CHECK(d.rankOf(order[r].second) == r);
+        CHECK(d.byRank(r).finalAvgCached() == order[r].first);
+        if (order[r].first >= Pipeline::PASS_CUTOFF) ++passed;
+    }
+    CHECK(d.passed() == passed);
+    CHECK(d.failed() == order.size() - passed);
+
+    // passed students are the prefix, failed the rest, both in order
+    std::vector<Id> seen;
+    d.forEachPassed([&](Id id, const Student& s) {
+        CHECK(Pipeline::isPassed(s));
+        seen.push_back(id);
+    });
+    CHECK(seen.size() == passed);
+    d.forEachFailed([&](Id id, const Student& s) {
+        CHECK(!Pipeline::isPassed(s));
+        seen.push_back(id);
+    });
+    CHECK(seen.size() == order.size());
+    for (std::size_t r = 0; r < order.size(); ++r) CHECK(seen[r] == order[r].second);
+
+    // nearest rank over the ascending grades
+    for (double p : {0.1, 1.0, 25.0, 50.0, 90.0, 99.9, 100.0}) {
+        if (order.empty()) {
+            CHECK(d.percentile(p) == 0.0);
+            continue;
+        }
+        auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(order.size())));
+        rank = std::clamp<std::size_t>(rank, 1, order.size());
+        CHECK(d.percentile(p) == order[order.size() - rank].first);
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(20240);
+    IncrementalDataset d;
+    std::map<Id, Student> live;
+    std::vector<Id> ids; // every id ever handed out, removed ones included
+
+    checkAll(d, live);
+    for (int op = 0; op < 20000; ++op) {
+        const unsigned kind = live.size() < 50 ? 0 : static_cast<unsigned>(rng() % 3);
+        if (kind == 0) {
+            Student s("N" + std::to_string(op), "S" + std::to_string(rng() % 100), randomHomework(rng),
+                      static_cast<int>(rng() % 11));
+            const Id id = d.add(s);
+            CHECK(live.count(id) == 0);
+            live.emplace(id, s);
+            ids.push_back(id);
+        } else {
+            const Id id = ids[rng() % ids.size()];
+            const bool known = live.count(id) != 0;
+            if (kind == 1) {
+                const auto hw = randomHomework(rng);
+                const int exam = static_cast<int>(rng() % 11);
+                CHECK(d.update(id, hw, exam) == known);
+                if (known) {
+                    Student& s = live.at(id);
+                    s = Student(s.getName(), s.getSurname(), hw, exam);
+                }
+            } else {
+                CHECK(d.remove(id) == known);
+                live.erase(id);
+            }
+            CHECK((d.find(id) != nullptr) == (live.count(id) != 0));
+            if (live.count(id)) CHECK(d.find(id)->finalAvgCached() == live.at(id).finalAvgCached());
+        }
+        if (op % 97 == 0) checkAll(d, live);
+    }
+    checkAll(d, live);
+
+    // emptied one by one, the counters come back to zero
+    for (const auto& entry : live) CHECK(d.remove(entry.first));
+    live.clear();
+    checkAll(d, live);
+    return 0;
+}
@@ -0,0 +1,54 @@
+// The trigram index answers every query exactly like the full scan (what
+// `search --verify` checks): substrings and prefixes of real names, short
+// patterns that fall back to the scan, misses, for every field, with the
+// index built on one thread or several.
+#include "FileGenerator.h"
+#include "NameSearch.h"
+#include "TestUtil.h"
+
+#include <algorithm>
+
+using Field = NameSearch::Field;
+
+// Substrings and prefixes cut from the records themselves, so most queries hit.
+static std::vector<std::string> patternsFrom(const std::vector<Student>& students) {
+    std::vector<std::string> patterns{"zzqx", "a b", "\xC5", "\xC5\xBE"};
+    for (std::size_t i = 0; i < students.size(); i += students.size() / 16) {
+        for (const std::string* field : {&students[i].getName(), &students[i].getSurname()}) {
+            for (std::size_t len = 1; len <= 6 && len <= field->size(); ++len) {
+                patterns.push_back(field->substr(0, len));
+                patterns.push_back(field->substr(field->size() - len));
+            }
+            if (field->size() > 4) patterns.push_back(field->substr(1, field->size() - 2));
+        }
+    }
+    return patterns;
+}
+
+int main() {
+    const FileGenerator::WorkloadProfile profiles[] = {FileGenerator::WorkloadProfile::Realistic,
+                                                       FileGenerator::WorkloadProfile::Utf8Names,
+                                                       FileGenerator::WorkloadProfile::LongNames};
+    for (auto profile : profiles) {
+        FileGenerator::GeneratorOptions opts;
+        opts.profile = profile;
+        FileGenerator::RecordSource source(5000, opts);
+        std::vector<Student> students;
+        for (Student s; source.next(s);) students.push_back(std::move(s));
+
+        const auto patterns = patternsFrom(students);
+        for (unsigned threads : {1u, 3u}) {
+            NameSearch index(students, threads);
+            CHECK(index.size() == students.size());
+            for (Field field : {Field::Any, Field::Name, Field::Surname}) {
+                for (const auto& p : patterns) {
+                    CHECK(index.findSubstring(p, field) == NameSearch::scanSubstring(students, p, field));
+                    CHECK(index.findPrefix(p, field) == NameSearch::scanPrefix(students, p, field));
+                }
+            }
+            // a pattern cut from a record finds at least that record
+            CHECK(!index.findPrefix(students.front().getSurname(), Field::Surname).empty());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+// With --order total every pipeline (container, split strategy, partition
+// mode, thread count) writes byte-identical passed/failed files: the packed
+// keys leave no ties for the containers' sorts to break differently.
+#include "Analyzer.h"
+#include "FileGenerator.h"
+#include "Sorter.h"
+#include "TestUtil.h"
+
+using Runner = PerfResult (*)(const std::string&, const std::string&, const std::string&, SplitStrategy,
+                              PartitionMode);
+
+struct Outputs {
+    std::string passed;
+    std::string failed;
+};
+
+static Outputs runPipeline(Runner run, const std::string& input, SplitStrategy strat, PartitionMode pmode,
+                           const TestUtil::ScratchDir& scratch) {
+    run(input, scratch.file("passed.txt"), scratch.file("failed.txt"), strat, pmode);
+    return {TestUtil::readAll(scratch.file("passed.txt")), TestUtil::readAll(scratch.file("failed.txt"))};
+}
+
+int main() {
+    TestUtil::ScratchDir scratch;
+    const std::string input = scratch.file("students.txt");
+    FileGenerator::GeneratorOptions gen;
+    gen.profile = FileGenerator::WorkloadProfile::Realistic; // duplicate surnames: many ties
+    FileGenerator::generateFile(input, 20000, gen);
+
+    const Runner runners[] = {Analyzer::runVectorPipeline, Analyzer::runDequePipeline, Analyzer::runListPipeline,
+                              Analyzer::runSegmentedPipeline, Analyzer::runPooledListPipeline};
+
+    Sorter::setOrder(Sorter::SortOrder::Total);
+    Analyzer::setThreads(1);
+    const Outputs reference = runPipeline(Analyzer::runVectorPipeline, input,
+                                          SplitStrategy::Strategy1_CopyToTwoContainers, PartitionMode::Partition,
+                                          scratch);
+    CHECK(!reference.passed.empty() && !reference.failed.empty());
+    for (unsigned threads : {1u, 4u}) {
+        Analyzer::setThreads(threads);
+        for (Runner run : runners) {
+            for (SplitStrategy strat : {SplitStrategy::Strategy1_CopyToTwoContainers,
+                                        SplitStrategy::Strategy2_MoveFailAndShrinkBase}) {
+                for (PartitionMode pmode : {PartitionMode::Partition, PartitionMode::StablePartition}) {
+                    const Outputs o = runPipeline(run, input, strat, pmode, scratch);
+                    CHECK(o.passed == reference.passed);
+                    CHECK(o.failed == reference.failed);
+                }
+            }
+        }
+    }
+    return 0;
+}